@@ -22,8 +22,7 @@ void AssembledMinion::assemble(Collective* col, Item* item, Position pos) const
         [&](const ItemType& t) { return t.get(factory); }), factory);
     for (auto& e : effects)
       e.apply((*c)->getPosition(), nullptr);
-    for (auto& a : (*c)->getAttributes().getAllAttr())
-      a.second *= scale;
+    (*c)->getAttributes().scaleBaseAttr(scale);
     for (auto& e : item->getAbility())
       (*c)->getSpellMap().add(*(*c)->getGame()->getContentFactory()->getCreatures().getSpell(e.spell.getId()),
           AttrType("DAMAGE"), 0);
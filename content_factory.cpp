@@ -340,6 +340,7 @@ optional<string> ContentFactory::readZLevels(const GameConfig* config, KeyVerifi
 }
 
 optional<string> ContentFactory::readData(const GameConfig* config, const vector<string>& modNames) {
+  config->preprocessAll();
   KeyVerifier keyVerifier;
   vector<PrimaryId<StorageId>> storageIds;
   if (auto error = config->readObject(storageIds, GameConfigId::STORAGE_IDS, &keyVerifier))
@@ -42,15 +42,40 @@ vector<string>& ContentId<T>::getAllIds() {
   return ret;
 }
 
+static size_t getStringHash(const char* text) {
+  size_t ret = 14695981039346656037ull;
+  for (; *text; ++text)
+    ret = (ret ^ (unsigned char)*text) * 1099511628211ull;
+  return ret;
+}
+
+// Ids are interned in an open addressing table that is hashed straight from the C string, so looking up an existing
+// id doesn't allocate. The table is kept at most half full, so most lookups finish on the first probe.
 template <typename T>
 int ContentId<T>::getId(const char* text) {
-  static unordered_map<string, int> ids;
-  static int generatedId = 0;
-  if (auto ret = getReferenceMaybe(ids, text))
-    return *ret;
-  ids[text] = generatedId;
-  getAllIds().push_back(text);
-  return generatedId++;
+  static vector<int> table;
+  auto& allIds = getAllIds();
+  auto findSlot = [&] (const char* s) {
+    size_t mask = table.size() - 1;
+    size_t index = getStringHash(s) & mask;
+    while (table[index] != -1 && strcmp(allIds[table[index]].data(), s))
+      index = (index + 1) & mask;
+    return index;
+  };
+  if (!table.empty()) {
+    auto slot = findSlot(text);
+    if (table[slot] != -1)
+      return table[slot];
+  }
+  int id = allIds.size();
+  allIds.push_back(text);
+  if (allIds.size() * 2 > table.size()) {
+    table = vector<int>(max<int>(64, table.size() * 2), -1);
+    for (int i : All(allIds))
+      table[findSlot(allIds[i].data())] = i;
+  } else
+    table[findSlot(text)] = id;
+  return id;
 }
 
 template <typename T>
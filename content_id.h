@@ -34,6 +34,31 @@ class ContentId {
 
 void setInitializedStatics();
 
+// Non-owning lookup from content ids to values kept elsewhere, stored densely by InternalId. Used to bypass map
+// lookups on hot paths once the content is loaded.
+template <typename Id, typename Value>
+class ContentIdIndex {
+  public:
+  template <typename Map, typename Fun>
+  void build(const Map& map, Fun getValue) {
+    values.clear();
+    for (auto& elem : map) {
+      auto index = elem.first.getInternalId();
+      if (index >= values.size())
+        values.resize(index + 1);
+      values[index] = getValue(elem.second);
+    }
+  }
+
+  const Value* get(Id id) const {
+    auto index = id.getInternalId();
+    return index < values.size() ? values[index] : nullptr;
+  }
+
+  private:
+  vector<const Value*> values;
+};
+
 template <typename T>
 class PrimaryId {
   public:
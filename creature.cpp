@@ -67,9 +67,12 @@
 #include "buff_info.h"
 #include "collective.h"
 #include "special_trait.h"
+#include "melee_batch.h"
 
 template <class Archive>
 void Creature::serialize(Archive& ar, const unsigned int version) {
+  if (!Archive::is_loading::value)
+    applyViewObjectUpdate();
   ar(SUBCLASS(OwnedObject<Creature>), SUBCLASS(Renderable), SUBCLASS(UniqueEntity), SUBCLASS(EventListener));
   ar(attributes, position, equipment, shortestPath, knownHiding, tribe);
   ar(deathTime, hidden, lastMoveCounter, effectFlags, duelInfo, leadershipExp);
@@ -80,6 +83,15 @@ void Creature::serialize(Archive& ar, const unsigned int version) {
   ar(vision, debt, lastCombatIntent, primaryViewId, steed, buffs, buffCount, buffPermanentCount);
   if (version == 1)
     ar(specialTraits);
+  if (Archive::is_loading::value)
+    // Companions don't save their master. The companions may still be loading, but these fields aren't saved.
+    for (int i : All(companions))
+      if (i < attributes->companions.size())
+        for (auto& elem : companions[i].creatures)
+          if (auto c = elem.get()) {
+            c->companionMaster = this;
+            c->hostileToMaster = attributes->companions[i].hostile;
+          }
 }
 
 SERIALIZABLE(Creature)
@@ -87,6 +99,8 @@ REGISTER_TYPE(ListenerTemplate<Creature>)
 
 SERIALIZATION_CONSTRUCTOR_IMPL(Creature)
 
+SLAB_ALLOCATED_IMPL(Creature)
+
 Creature::Creature(const ViewObject& object, TribeId t, CreatureAttributes attr, SpellMap spellMap)
     : Renderable(object), attributes(std::move(attr)), tribe(t), spellMap(std::move(spellMap)) {
   modViewObject().setGenericId(getUniqueId().getGenericId());
@@ -120,6 +134,7 @@ const ViewObject& Creature::getViewObjectFor(const Tribe* observer) const {
 }
 
 void Creature::setAlternativeViewId(optional<ViewId> id) {
+  movementType.clear();
   if (id) {
     primaryViewId = getViewObject().id();
     modViewObject().setId(*id);
@@ -179,6 +194,10 @@ const CreatureAttributes& Creature::getAttributes() const {
   return *attributes;
 }
 
+int Creature::getAttributesGeneration() const {
+  return attributesGeneration;
+}
+
 CreatureAttributes& Creature::getAttributes() {
   return *attributes;
 }
@@ -210,7 +229,11 @@ pair<CreatureAttributes, SpellMap> Creature::setAttributes(CreatureAttributes at
   auto ret = make_pair(std::move(*attributes), std::move(*spellMap));
   ret.first.permanentBuffs = std::move(permanentBuffs);
   attributes = std::move(attr);
+  ++attributesGeneration;
   spellMap = std::move(spells);
+  companionsChanged = true;
+  clearAttrCache();
+  movementType.clear();
   modViewObject() = attributes->createViewObject();
   modViewObject().setGenericId(getUniqueId().getGenericId());
   modViewObject().setModifier(ViewObject::Modifier::CREATURE);
@@ -274,7 +297,7 @@ void Creature::updateLastingFX(ViewObject& object, const ContentFactory* factory
     object.particleEffects.insert(FXVariantName::LICH);
   if (auto time = getGlobalTime())
     for (auto effect : ENUM_ALL(LastingEffect))
-      if (isAffected(effect, *time))
+      if (mayBeAffected(effect) && isAffected(effect, *time))
         if (auto fx = LastingEffects::getFX(effect))
           object.particleEffects.insert(*fx);
   for (auto& buff : buffs)
@@ -422,8 +445,11 @@ CreatureAction Creature::forceMove(Vec2 dir) const {
 
 void Creature::setForceMovement(bool value) {
   forceMovement = value;
-  if (auto steed = getSteed())
+  movementType.clear();
+  if (auto steed = getSteed()) {
     steed->forceMovement = value;
+    steed->movementType.clear();
+  }
 }
 
 CreatureAction Creature::forceMove(Position pos) const {
@@ -1023,6 +1049,11 @@ bool Creature::isAffected(LastingEffect effect) const {
     return attributes->isAffectedPermanently(effect);
 }
 
+bool Creature::mayBeAffected(LastingEffect effect) const {
+  return attributes->getActiveLastingEffects().contains(effect) ||
+      (steed && LastingEffects::inheritsFromSteed(effect));
+}
+
 bool Creature::isAffected(LastingEffect effect, optional<GlobalTime> time) const {
   PROFILE;
   if (LastingEffects::inheritsFromSteed(effect) && steed)
@@ -1064,6 +1095,8 @@ bool Creature::addEffect(BuffId id, TimeInterval time, GlobalTime global, const
   };
   if (add()) {
     buffs.push_back(make_pair(id, global + time));
+    movementType.clear();
+    ++buffsVersion;
     if (++buffCount[id] == 1 || info.stacks) {
       if (msg && info.addedMessage)
         applyMessage(*info.addedMessage, this);
@@ -1084,6 +1117,8 @@ bool Creature::addEffect(BuffId id, TimeInterval time, bool msg) {
 bool Creature::removeBuff(int index, bool msg) {
   auto id = buffs[index].first;
   buffs.removeIndex(index);
+  movementType.clear();
+  ++buffsVersion;
   auto& info = getGame()->getContentFactory()->buffs.at(id);
   if (--buffCount[id] == 0 || info.stacks) {
     if (buffCount[id] == 0)
@@ -1108,6 +1143,8 @@ bool Creature::addPermanentEffect(BuffId id, int count, bool msg, const ContentF
   if (!factory)
     factory = getGame()->getContentFactory();
   auto& info = factory->buffs.at(id);
+  movementType.clear();
+  ++buffsVersion;
   if (++buffPermanentCount[id] == 1) {
     if (msg && info.addedMessage)
       applyMessage(*info.addedMessage, this);
@@ -1122,6 +1159,8 @@ bool Creature::removePermanentEffect(BuffId id, int count, bool msg, const Conte
   if (!factory)
     factory = getGame()->getContentFactory();
   auto& info = factory->buffs.at(id);
+  movementType.clear();
+  ++buffsVersion;
   if (--buffPermanentCount[id] <= 0) {
     buffPermanentCount.erase(id);
     if (msg && info.removedMessage)
@@ -1165,12 +1204,36 @@ int Creature::getAttr(AttrType type, bool includeWeapon, bool includeTeamExp) co
   return getAttrWithExp(type, getCombatExperience(true, includeTeamExp), includeWeapon);
 }
 
-int Creature::getAttrWithExp(AttrType type, int combatExp, bool includeWeapon) const {
-  PROFILE
+int Creature::computeAttrWithExp(AttrType type, int combatExp, bool includeWeapon) const {
   auto raw = getRawAttr(type, combatExp);
   return max(0, raw + getAttrBonus(type, raw, includeWeapon));
 }
 
+int Creature::getAttrWithExp(AttrType type, int combatExp, bool includeWeapon) const {
+  PROFILE
+  // Without a model there is no move counter to expire the cache.
+  if (!position.getModel())
+    return computeAttrWithExp(type, combatExp, includeWeapon);
+  auto moveId = getCurrentMoveId();
+  if (!attrCache || attrCache->moveId != moveId || attrCache->attributesVersion != attributes->getVersion() ||
+      attrCache->equipmentVersion != equipment->getVersion())
+    attrCache = AttrCache{moveId, attributes->getVersion(), equipment->getVersion(), {}};
+  for (auto& elem : attrCache->values)
+    if (elem.type == type && elem.combatExp == combatExp && elem.includeWeapon == includeWeapon) {
+#ifdef CHECK_ATTR_CACHE
+      CHECK(elem.value == computeAttrWithExp(type, combatExp, includeWeapon)) << "Stale attribute " << type << " of " << identify();
+#endif
+      return elem.value;
+    }
+  auto value = computeAttrWithExp(type, combatExp, includeWeapon);
+  attrCache->values.push_back(CachedAttr{type, combatExp, includeWeapon, value});
+  return value;
+}
+
+void Creature::clearAttrCache() {
+  attrCache = none;
+}
+
 int Creature::getSpecialAttr(AttrType type, const Creature* against) const {
   int ret = 0;
   if (auto elems = getReferenceMaybe(attributes->specialAttr, type))
@@ -1184,6 +1247,25 @@ int Creature::getSpecialAttr(AttrType type, const Creature* against) const {
   return ret;
 }
 
+bool Creature::hasSpecialAttr(AttrType type) const {
+  if (attributes->specialAttr.count(type))
+    return true;
+  for (auto& item : equipment->getAllEquipped())
+    if (item->getSpecialModifiers().count(type))
+      return true;
+  return false;
+}
+
+int Creature::getMeleeStrength(const pair<Item*, double>& weapon, const Creature* victim) const {
+  auto attr = weapon.first->getWeaponInfo().meleeAttackAttr;
+  return max(1, int(weapon.second * (getAttr(attr, false) + getSpecialAttr(attr, victim) +
+      weapon.first->getModifier(attr))));
+}
+
+int Creature::getBuffsVersion() const {
+  return buffsVersion;
+}
+
 int Creature::getPoints() const {
   return points;
 }
@@ -1282,6 +1364,7 @@ void Creature::onKilledOrCaptured(Creature* victim) {
       if (!killTitles.contains(title)) {
         attributes->getName().setKillTitle(title);
         killTitles.push_back(title);
+        clearAttrCache();
       }
     }
     if (attributes->afterKilledSomeone)
@@ -1303,6 +1386,7 @@ TribeId Creature::getTribeId() const {
 
 void Creature::setTribe(TribeId t) {
   tribe = t;
+  movementType.clear();
 }
 
 bool Creature::isFriend(const Creature* c) const {
@@ -1341,6 +1425,9 @@ void Creature::setPosition(Position pos) {
   if (shortestPath && shortestPath->getLevel() != pos.getLevel())
     shortestPath = none;
   position = pos;
+  // Swarmer bonuses and the held state depend on the neighbours.
+  clearAttrCache();
+  movementType.clear();
   if (nextPosIntent && !position.isSameLevel(*nextPosIntent))
     nextPosIntent = none;
   if (steed)
@@ -1409,6 +1496,9 @@ void Creature::tick() {
     return;
   tickCompanions();
   for (LastingEffect effect : ENUM_ALL(LastingEffect)) {
+    // The set changes as effects are processed, so it's fetched again for every effect.
+    if (!mayBeAffected(effect))
+      continue;
     if (attributes->considerTimeout(effect, time))
       LastingEffects::onTimedOut(this, effect, true);
     if (isDead())
@@ -1499,6 +1589,7 @@ static optional<Position> getCompanionPosition(Creature* c) {
 }
 
 void Creature::removeCompanions(int index) {
+  companionsChanged = true;
   attributes->companions.removeIndexPreserveOrder(index);
   if (index < companions.size()) {
     for (auto c : companions[index].creatures)
@@ -1510,35 +1601,65 @@ void Creature::removeCompanions(int index) {
   }
 }
 
-void Creature::tickCompanions() {
-  PROFILE;
-  for (auto& summonsType : companions)
-    for (auto elem : copyOf(summonsType.creatures)) {
-      if (elem->isDead())
-        summonsType.creatures.removeElement(elem);
-      else if (summonsType.statsBase) { // update the spirit's attributes
-        auto base = getAttr(*summonsType.statsBase);
-        elem->getAttributes().setBaseAttr(AttrType("DEFENSE"), base);
-        for (auto& attr : getGame()->getContentFactory()->attrInfo)
-          if (attr.second.isAttackAttr)
-            elem->getAttributes().setBaseAttr(attr.first, base);
-      }
-    }
+void Creature::initializeCompanion(Creature* c, const CompanionInfo& info) {
+  c->companionMaster = this;
+  if (info.hostile) {
+    if (c->getTribeId() != TribeId::getHostile())
+      c->setTribe(TribeId::getHostile());
+    c->hostileToMaster = true;
+  }
+}
+
+void Creature::updateCompanionGroups() {
   while (companions.size() < attributes->companions.size())
     companions.push_back(CompanionGroup{{}, attributes->companions[companions.size()].statsBase,
         attributes->companions[companions.size()].getsKillCredit});
+  activeCompanionGroups.clear();
   for (int i : All(attributes->companions)) {
+    auto& group = companions[i];
+    auto& summonsInfo = attributes->companions[i];
+    for (auto elem : copyOf(group.creatures))
+      if (elem->isDead())
+        group.creatures.removeElement(elem);
+      else
+        initializeCompanion(elem.get(), summonsInfo);
+    if (group.creatures.size() < summonsInfo.count || group.statsBase)
+      activeCompanionGroups.push_back(i);
+  }
+  companionsChanged = false;
+}
+
+void Creature::tickCompanions() {
+  PROFILE;
+  if (companionsChanged || companions.size() < attributes->companions.size())
+    updateCompanionGroups();
+  bool filled = false;
+  for (int i : activeCompanionGroups) {
+    auto& group = companions[i];
     auto& summonsInfo = attributes->companions[i];
-    if (companions[i].creatures.size() < summonsInfo.count && Random.chance(summonsInfo.summonFreq))
-      append(companions[i].creatures, summonPersonal(this, Random.choose(summonsInfo.creatures),
+    if (group.statsBase) { // update the spirits' attributes
+      auto base = getAttr(*group.statsBase);
+      for (auto elem : group.creatures)
+        if (!elem->isDead()) {
+          elem->getAttributes().setBaseAttr(AttrType("DEFENSE"), base);
+          for (auto& attr : getGame()->getContentFactory()->attrInfo)
+            if (attr.second.isAttackAttr)
+              elem->getAttributes().setBaseAttr(attr.first, base);
+        }
+    }
+    if (group.creatures.size() < summonsInfo.count && Random.chance(summonsInfo.summonFreq)) {
+      auto summoned = summonPersonal(this, Random.choose(summonsInfo.creatures),
           summonsInfo.statsBase ? optional<int>(getAttr(*summonsInfo.statsBase)) : optional<int>(),
-          summonsInfo.spawnAway ? getCompanionPosition(this) : none));
-    if (summonsInfo.hostile)
-      for (auto c : companions[i].creatures) {
-        c->setTribe(TribeId::getHostile());
-        c->unknownAttackers.insert(this);
-      }
+          summonsInfo.spawnAway ? getCompanionPosition(this) : none);
+      for (auto c : summoned)
+        initializeCompanion(c, summonsInfo);
+      append(group.creatures, summoned);
+      filled |= group.creatures.size() >= summonsInfo.count;
+    }
   }
+  if (filled)
+    activeCompanionGroups = activeCompanionGroups.filter([this](int i) {
+        return companions[i].creatures.size() < attributes->companions[i].count || !!companions[i].statsBase; });
 }
 
 vector<Creature*> Creature::getCompanions(bool withNoKillCreditOnly) const {
@@ -1644,13 +1765,16 @@ CreatureAction Creature::attack(Creature* other) const {
     other->addCombatIntent(self, CombatIntentInfo::Type::ATTACK);
     INFO << getName().the() << " attacking " << other->getName().the();
     bool wasDamaged = false;
-    for (auto weapon : weapons) {
+    optional<MeleeBatch> batch;
+    if (MeleeBatch::isEnabled())
+      batch.emplace(self, other, weapons);
+    for (int hit : All(weapons)) {
+      auto& weapon = weapons[hit];
       auto weaponInfo = weapon.first->getWeaponInfo();
-      auto damageAttr = weaponInfo.meleeAttackAttr;
-      const int damage = max(1, int(weapon.second * (getAttr(damageAttr, false) +
-          getSpecialAttr(damageAttr, other) + weapon.first->getModifier(damageAttr))));
+      const int damage = batch ? batch->getStrength(hit) : getMeleeStrength(weapon, other);
       AttackLevel attackLevel = Random.choose(getBody().getAttackLevels());
-      damageAttr = modifyDamageAttr(damageAttr, getGame()->getContentFactory());
+      auto damageAttr = batch ? batch->getDamageAttr(hit) :
+          modifyDamageAttr(weaponInfo.meleeAttackAttr, getGame()->getContentFactory());
       vector<Effect> victimEffects;
       for (auto& e : weaponInfo.victimEffect)
         if (Random.chance(e.chance))
@@ -1661,12 +1785,14 @@ CreatureAction Creature::attack(Creature* other) const {
         enemyName = "something";
       weapon.first->getAttackMsg(this, enemyName);
       getGame()->addEvent(EventInfo::CreatureAttacked{other, self, damageAttr});
-      wasDamaged |= other->takeDamage(attack);
+      wasDamaged |= batch ? other->takeDamage(attack, *batch, hit) : other->takeDamage(attack);
       for (auto& e : weaponInfo.attackerEffect) {
         e.apply(position);
         if (self->isDead())
           break;
       }
+      if (batch && !weaponInfo.attackerEffect.empty())
+        batch->invalidate();
       if (self->isDead() || other->isDead() || other->isAffected(LastingEffect::STUNNED) ||
           other->position.dist8(position).value_or(2) > 1)
         break;
@@ -1704,20 +1830,6 @@ void Creature::setDuel(TribeId enemyTribe, Creature* opponent, GlobalTime timeou
     steed->duelInfo = DuelInfo{enemyTribe, Creature::Id{}, timeout};
 }
 
-constexpr double getDamage(double damageRatio) {
-  constexpr double minRatio = 0.3;  // the ratio at which the damage drops to 0
-  constexpr double maxRatio = 2.2;     // the ratio at which the damage reaches 1
-  constexpr double damageAtOne = 0.12;// damage dealt at a ratio of 1
-  if (damageRatio <= minRatio)
-    return 0;
-  else if (damageRatio <= 1)
-    return damageAtOne * (damageRatio - minRatio) / (1.0 - minRatio);
-  else if (damageRatio <= maxRatio)
-    return damageAtOne + (1.0 - damageAtOne) * (damageRatio - 1.0) / (maxRatio - 1.0);
-  else
-    return 1.0;
-}
-
 bool Creature::captureDamage(double damage, Creature* attacker) {
   getBody().bleed(this, damage);
   auto factory = getGame()->getContentFactory();
@@ -1757,11 +1869,28 @@ double Creature::getFlankedMod() const {
   return pow(1.07, min(0, cnt));
 }
 
+double Creature::getMeleeDefense(double defense, AttrType damageType) const {
+  defense *= getFlankedMod();
+  for (LastingEffect effect : ENUM_ALL(LastingEffect))
+    if (mayBeAffected(effect) && isAffected(effect))
+      defense = LastingEffects::modifyCreatureDefense(this, effect, defense, damageType);
+  auto factory = getGame()->getContentFactory();
+  auto modifyDefense = [&](BuffId id) {
+    auto& info = factory->buffs.at(id);
+    if (!info.defenseMultiplierAttr || info.defenseMultiplierAttr == damageType)
+      defense *= info.defenseMultiplier;
+  };
+  for (auto& buff : buffs)
+    modifyDefense(buff.first);
+  for (auto& buff : buffPermanentCount)
+    modifyDefense(buff.first);
+  return defense;
+}
+
 bool Creature::takeDamage(const Attack& attack) {
   if (steed && Random.roll(10))
     return steed->takeDamage(attack);
   PROFILE;
-  const double hitPenalty = 0.95;
   double defense = getAttr(AttrType("DEFENSE"));
   if (Creature* attacker = attack.attacker) {
     onAttackedBy(attacker);
@@ -1770,21 +1899,30 @@ bool Creature::takeDamage(const Attack& attack) {
         c->removeEffect(LastingEffect::SLEEP);
     defense += getSpecialAttr(AttrType("DEFENSE"), attacker);
   }
-  defense *= getFlankedMod();
-  for (LastingEffect effect : ENUM_ALL(LastingEffect))
-    if (isAffected(effect))
-      defense = LastingEffects::modifyCreatureDefense(this, effect, defense, attack.damageType);
+  return applyDamage(attack, getMeleeDamage((double) attack.strength / getMeleeDefense(defense, attack.damageType)));
+}
+
+bool Creature::takeDamage(const Attack& attack, MeleeBatch& batch, int hit) {
+  if (steed)
+    return takeDamage(attack);
+  PROFILE;
+  int defense = getAttr(AttrType("DEFENSE"));
+  onAttackedBy(attack.attacker);
+  for (auto c : getVisibleCreatures())
+    if (*c->getPosition().dist8(position) < 10)
+      if (c->removeEffect(LastingEffect::SLEEP))
+        batch.invalidate();
+  // Effects and captures may change anything around, including tribes and the creatures flanking the victim.
+  bool changesState = capture || !attack.effect.empty() ||
+      getGame()->getContentFactory()->attrInfo.at(attack.damageType).onAttackedEffect;
+  bool ret = applyDamage(attack, batch.getDamage(hit, defense));
+  if (changesState)
+    batch.invalidate();
+  return ret;
+}
+
+bool Creature::applyDamage(const Attack& attack, double damage) {
   auto factory = getGame()->getContentFactory();
-  auto modifyDefense = [&](BuffId id) {
-    auto& info = factory->buffs.at(id);
-    if (!info.defenseMultiplierAttr || info.defenseMultiplierAttr == attack.damageType)
-      defense *= info.defenseMultiplier;
-  };
-  for (auto& buff : buffs)
-    modifyDefense(buff.first);
-  for (auto& buff : buffPermanentCount)
-    modifyDefense(buff.first);
-  double damage = getDamage((double) attack.strength / defense);
   if (attack.withSound)
     if (auto sound = attributes->getAttackSound(attack.type, damage > 0))
       position.addSound(*sound);
@@ -1814,7 +1952,7 @@ bool Creature::takeDamage(const Attack& attack) {
       break;
   }
   for (LastingEffect effect : ENUM_ALL(LastingEffect))
-    if (isAffected(effect))
+    if (mayBeAffected(effect) && isAffected(effect))
       LastingEffects::afterCreatureDamage(this, effect);
   return returnValue;
 }
@@ -1833,9 +1971,37 @@ void Creature::updateViewObjectFlanking() {
     object.resetAttribute(ViewObject::Attribute::FLANKED_MOD);
 }
 
+const ViewObject& Creature::getViewObject() const {
+  applyViewObjectUpdate();
+  return Renderable::getViewObject();
+}
+
+ViewObject& Creature::modViewObject() {
+  applyViewObjectUpdate();
+  return Renderable::modViewObject();
+}
+
+void Creature::applyViewObjectUpdate() const {
+  if (auto factory = pendingViewObjectUpdate) {
+    pendingViewObjectUpdate = nullptr;
+    const_cast<Creature*>(this)->rebuildViewObject(factory);
+  }
+}
+
 void Creature::updateViewObject(const ContentFactory* factory) {
+  // Creatures outside of a game can outlive the factory, for example in tests, so they are rebuilt right away.
+  if (!getGame()) {
+    pendingViewObjectUpdate = nullptr;
+    rebuildViewObject(factory);
+    return;
+  }
+  pendingViewObjectUpdate = factory;
+  getPosition().setNeedsRenderUpdate(true);
+}
+
+void Creature::rebuildViewObject(const ContentFactory* factory) {
   PROFILE;
-  auto& object = modViewObject();
+  auto& object = Renderable::modViewObject();
   auto attrs = ViewObject::CreatureAttributes();
   attrs.reserve(factory->attrInfo.size());
   for (auto& attr : factory->attrInfo)
@@ -1914,6 +2080,7 @@ bool Creature::heal(double amount) {
 
 void Creature::setHeld(Creature* c) {
   holding = c->getUniqueId();
+  movementType.clear();
 }
 
 Creature* Creature::getHoldingCreature() const {
@@ -2049,6 +2216,10 @@ void Creature::dieWithAttacker(Creature* attacker, DropType drops) {
   CHECK(!isDead()) << getName().bare() << " is already dead. " << getDeathReason().value_or("");
   if (considerPhylacteryOrSavingLife(drops, attacker))
     return;
+  // The body is still on the level, so this is the last chance to bring the view object up to date.
+  applyViewObjectUpdate();
+  if (auto master = companionMaster.get())
+    master->companionsChanged = true;
   if (isAffected(LastingEffect::FROZEN) && drops == DropType::EVERYTHING)
     drops = DropType::ONLY_INVENTORY;
   getController()->onKilled(attacker);
@@ -2171,11 +2342,13 @@ void Creature::removeGameReferences() {
   nextPosIntent.reset();
   while (!controllerStack.empty())
     popController();
-  visibleEnemies.reset();
-  visibleCreatures.reset();
+  visibleEnemies.clear();
+  visibleCreatures.clear();
+  movementType.clear();
   lastCombatIntent.reset();
   gameCache = nullptr;
   companions.clear();
+  companionMaster = nullptr;
   phylactery = none;
 }
 
@@ -2653,9 +2826,12 @@ MovementType Creature::getMovementTypeNotSteed(Game* game) const {
 MovementType Creature::getMovementType(Game* game) const {
   PROFILE;
   if (steed)
-    return steed->getMovementTypeNotSteed(game);
-  else
+    return steed->getMovementType(game);
+  // Without a model there is no move counter to expire the cache.
+  if (!position.getModel())
     return getMovementTypeNotSteed(game);
+  return movementType.get(std::make_tuple(getCurrentMoveId(), game, attributes->getVersion()),
+      [&] { return getMovementTypeNotSteed(game); });
 }
 
 int Creature::getDifficultyPoints() const {
@@ -2800,7 +2976,7 @@ bool Creature::atTarget() const {
 }
 
 bool Creature::isUnknownAttacker(const Creature* c) const {
-  return unknownAttackers.contains(c);
+  return unknownAttackers.contains(c) || (hostileToMaster && companionMaster.get() == c);
 }
 
 const Vision& Creature::getVision() const {
@@ -2831,10 +3007,7 @@ const vector<Creature*>& Creature::getVisibleEnemies() const {
       }
     return ret;
   };
-  auto currentMoveId = getCurrentMoveId();
-  if (!visibleEnemies || visibleEnemies->first != currentMoveId)
-    visibleEnemies.emplace(make_pair(currentMoveId, get()));
-  return visibleEnemies->second;
+  return visibleEnemies.get(getCurrentMoveId(), get);
 }
 
 const vector<Creature*>& Creature::getVisibleCreatures() const {
@@ -2855,10 +3028,7 @@ const vector<Creature*>& Creature::getVisibleCreatures() const {
         }
     return ret;
   };
-  auto currentMoveId = getCurrentMoveId();
-  if (!visibleCreatures || visibleCreatures->first != currentMoveId)
-    visibleCreatures.emplace(make_pair(currentMoveId, get()));
-  return visibleCreatures->second;
+  return visibleCreatures.get(getCurrentMoveId(), get);
 }
 
 bool Creature::shouldAIAttack(const Creature* other) const {
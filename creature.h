@@ -34,6 +34,8 @@
 #include "attr_type.h"
 #include "buff_id.h"
 #include "player_message.h"
+#include "slab_allocator.h"
+#include "move_cache.h"
 
 class SpecialTrait;
 class Level;
@@ -65,6 +67,8 @@ class SpellSchool;
 class ContentFactory;
 struct AutomatonPart;
 struct PromotionInfo;
+class MeleeBatch;
+struct CompanionInfo;
 
 class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedObject<Creature>, public EventListener<Creature> {
   public:
@@ -76,6 +80,9 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
       function<string(Creature*)> addSuffix = [](Creature*) { return ""; });
 
   const ViewObject& getViewObjectFor(const Tribe* observer) const;
+  // Hide the Renderable accessors, so that a pending updateViewObject is applied before the object is used.
+  const ViewObject& getViewObject() const;
+  ViewObject& modViewObject();
   void setAlternativeViewId(optional<ViewId>);
   bool hasAlternativeViewId() const;
   void setViewId(ViewId);
@@ -96,6 +103,7 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
   Position getPosition() const;
   bool dodgeAttack(const Attack&);
   bool takeDamage(const Attack&);
+  bool takeDamage(const Attack&, MeleeBatch&, int hit);
   void onAttackedBy(Creature*);
   bool heal(double amount = 1000);
   void setTeamExperience(double, bool leadershipExp);
@@ -123,7 +131,16 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
   int getAttr(AttrType, bool includeWeapon = true, bool includeTeamExp = true) const;
   int getAttrWithExp(AttrType, int combatExperience, bool includeWeapon = true) const;
   int getSpecialAttr(AttrType, const Creature* against) const;
+  bool hasSpecialAttr(AttrType) const;
+  int getMeleeStrength(const pair<Item*, double>& weapon, const Creature* victim) const;
+  // Applies flanking, lasting effects and buffs to the given defense.
+  double getMeleeDefense(double defense, AttrType damageType) const;
+  AttrType modifyDamageAttr(AttrType, const ContentFactory*) const;
+  // Changes whenever a buff is added or removed.
+  int getBuffsVersion() const;
   int getAttrBonus(AttrType, int rawAttr, bool includeWeapon) const;
+  // Attribute values are cached for the current move. Call this after changing equipped items in place.
+  void clearAttrCache();
 
   double getFlankedMod() const;
   int getPoints() const;
@@ -143,6 +160,8 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
 
   const CreatureAttributes& getAttributes() const;
   CreatureAttributes& getAttributes();
+  // Changes whenever the attributes are swapped out. Creature id, body material and hated by effect are fixed in between.
+  int getAttributesGeneration() const;
   pair<CreatureAttributes, SpellMap> setAttributes(CreatureAttributes, SpellMap);
   void pushAttributes(CreatureAttributes, SpellMap);
   void popAttributes();
@@ -280,6 +299,7 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
   SpellMap& getSpellMap();
 
   SERIALIZATION_DECL(Creature)
+  SLAB_ALLOCATED(Creature)
 
   bool addEffect(LastingEffect, TimeInterval time, bool msg = true);
   bool addEffect(LastingEffect, TimeInterval time, GlobalTime, bool msg = true, const ContentFactory* = nullptr);
@@ -324,6 +344,8 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
   int getCombatExperienceCap() const;
   int getRawAttr(AttrType, int combatExp) const;
 
+  // Marks the view object as outdated. It's rebuilt when it's next read, so creatures that nobody looks at
+  // don't pay for it, and several updates in one turn cost a single rebuild.
   void updateViewObject(const ContentFactory*);
   void updateViewObjectFlanking();
   void swapPosition(Vec2 direction, bool withExcuseMe = true);
@@ -406,8 +428,26 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
   int SERIAL(points) = 0;
   using MoveId = pair<int, LevelId>;
   MoveId getCurrentMoveId() const;
-  mutable optional<pair<MoveId, vector<Creature*>>> visibleEnemies;
-  mutable optional<pair<MoveId, vector<Creature*>>> visibleCreatures;
+  mutable MoveCache<MoveId, vector<Creature*>> visibleEnemies{"visibleEnemies"};
+  mutable MoveCache<MoveId, vector<Creature*>> visibleCreatures{"visibleCreatures"};
+  // Also cleared on changes to buffs, tribe, view id, forced movement and position.
+  mutable MoveCache<std::tuple<MoveId, Game*, int>, MovementType> movementType{"movementType"};
+  struct CachedAttr {
+    AttrType type;
+    int combatExp;
+    bool includeWeapon;
+    int value;
+  };
+  struct AttrCache {
+    MoveId moveId;
+    int attributesVersion;
+    int equipmentVersion;
+    vector<CachedAttr> values;
+  };
+  mutable optional<AttrCache> attrCache;
+  int attributesGeneration = 0;
+  int buffsVersion = 0;
+  int computeAttrWithExp(AttrType, int combatExp, bool includeWeapon) const;
   HeapAllocated<Vision> SERIAL(vision);
   bool forceMovement = false;
   void setForceMovement(bool value);
@@ -417,10 +457,14 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
   EnumSet<CreatureStatus> SERIAL(statuses);
   bool SERIAL(capture) = 0;
   bool captureDamage(double damage, Creature* attacker);
+  bool applyDamage(const Attack&, double damage);
   mutable Game* gameCache = nullptr;
   optional<GlobalTime> SERIAL(globalTime);
   void considerMovingFromInaccessibleSquare();
   void updateLastingFX(ViewObject&, const ContentFactory*);
+  mutable const ContentFactory* pendingViewObjectUpdate = nullptr;
+  void applyViewObjectUpdate() const;
+  void rebuildViewObject(const ContentFactory*);
   HeapAllocated<SpellMap> SERIAL(spellMap);
   optional<ViewId> SERIAL(primaryViewId);
   struct CompanionGroup {
@@ -430,9 +474,21 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
     SERIALIZE_ALL(creatures, statsBase, getsKillCredit)
   };
   vector<CompanionGroup> SERIAL(companions);
+  // Groups that can respawn or copy the master's stats. Full groups without a stats base are left alone until
+  // a companion dies or the groups change. Not saved, so all groups are checked on the first tick after loading.
+  vector<int> activeCompanionGroups;
+  bool companionsChanged = true;
+  // Set on companions by their master when summoned, rebuilding the groups or loading, so they can tell the master
+  // about their death.
+  WeakPointer<Creature> companionMaster;
+  bool hostileToMaster = false;
   void tickCompanions();
+  void updateCompanionGroups();
+  void initializeCompanion(Creature*, const CompanionInfo&);
   bool considerSavingLife(DropType, const Creature* attacker);
   void tryToDestroyLastingEffect(LastingEffect);
+  // False if the effect is certainly not affecting the creature. Cheaper than isAffected.
+  bool mayBeAffected(LastingEffect) const;
   vector<AdjectiveInfo> getSpecialAttrAdjectives(const ContentFactory*, bool good) const;
   vector<AutomatonPart> SERIAL(automatonParts);
   vector<pair<CreatureAttributes, SpellMap>> SERIAL(attributesStack);
@@ -458,7 +514,6 @@ class Creature : public Renderable, public UniqueEntity<Creature>, public OwnedO
     SERIALIZE_ALL(villageName, kills)
   };
   optional<ButcherInfo> SERIAL(butcherInfo);
-  AttrType modifyDamageAttr(AttrType, const ContentFactory*) const;
   struct DuelInfo {
     TribeId SERIAL(enemy);
     Creature::Id SERIAL(opponent);
@@ -36,6 +36,21 @@
 void CreatureAttributes::initializeLastingEffects() {
   for (LastingEffect effect : ENUM_ALL(LastingEffect))
     lastingEffects[effect] = GlobalTime(-500);
+  activeLastingEffects = none;
+  ++version;
+}
+
+const EnumSet<LastingEffect>& CreatureAttributes::getActiveLastingEffects() const {
+  if (!activeLastingEffects)
+    activeLastingEffects = EnumSet<LastingEffect>([this](LastingEffect effect) {
+        return lastingEffects[effect] > GlobalTime(0) || permanentEffects[effect] > 0; });
+  return *activeLastingEffects;
+}
+
+void CreatureAttributes::updateActiveLastingEffect(LastingEffect effect) {
+  if (activeLastingEffects)
+    activeLastingEffects->set(effect, lastingEffects[effect] > GlobalTime(0) || permanentEffects[effect] > 0);
+  ++version;
 }
 
 void CreatureAttributes::randomize() {
@@ -104,17 +119,28 @@ const CreatureName& CreatureAttributes::getName() const {
   return name;
 }
 
+int CreatureAttributes::getVersion() const {
+  return version;
+}
+
 void CreatureAttributes::increaseBaseAttr(AttrType type, int v) {
   attr[type] += v;
   attr[type] = max(0, attr[type]);
+  ++version;
 }
 
-HashMap<AttrType, int>& CreatureAttributes::getAllAttr() {
-  return attr;
+void CreatureAttributes::scaleBaseAttr(double scale) {
+  for (auto& a : attr)
+    a.second *= scale;
+  ++version;
 }
 
 void CreatureAttributes::setBaseAttr(AttrType type, int v) {
-  attr[type] = max(0, v);
+  auto& value = attr[type];
+  if (value != max(0, v)) {
+    value = max(0, v);
+    ++version;
+  }
 }
 
 void CreatureAttributes::setAIType(AIType type) {
@@ -163,11 +189,13 @@ const HashMap<AttrType, int>& CreatureAttributes::getMaxExpLevel() const {
 void CreatureAttributes::increaseMaxExpLevel(AttrType type, int increase) {
   maxLevelIncrease[type] = max(0, maxLevelIncrease[type] + increase);
   expLevel[type] = min<double>(expLevel[type], maxLevelIncrease[type]);
+  ++version;
 }
 
 void CreatureAttributes::increaseExpLevel(AttrType type, double increase) {
   increase = max(0.0, min(increase, (double) maxLevelIncrease[type] - expLevel[type]));
   expLevel[type] += increase;
+  ++version;
 }
 
 bool CreatureAttributes::isTrainingMaxedOut(AttrType type) const {
@@ -215,6 +243,8 @@ void CreatureAttributes::add(BodyPart p, int count, const ContentFactory* factor
   for (auto effect : ENUM_ALL(LastingEffect))
     if (body->isIntrinsicallyAffected(effect, factory))
       ++permanentEffects[effect];
+  activeLastingEffects = none;
+  ++version;
 }
 
 optional<string> CreatureAttributes::getPetReaction(const Creature* me) const {
@@ -258,6 +288,8 @@ GlobalTime CreatureAttributes::getTimeOut(LastingEffect effect) const {
 void CreatureAttributes::copyLastingEffects(const CreatureAttributes& attr) {
   lastingEffects = attr.lastingEffects;
   permanentEffects[LastingEffect::STEED] = attr.permanentEffects[LastingEffect::STEED];
+  activeLastingEffects = none;
+  ++version;
 }
 
 bool CreatureAttributes::considerTimeout(LastingEffect effect, GlobalTime current) {
@@ -272,6 +304,7 @@ bool CreatureAttributes::considerTimeout(LastingEffect effect, GlobalTime curren
 void CreatureAttributes::addLastingEffect(LastingEffect effect, GlobalTime endTime) {
   if (lastingEffects[effect] < endTime)
     lastingEffects[effect] = endTime;
+  updateActiveLastingEffect(effect);
 }
 
 static bool consumeProb() {
@@ -325,6 +358,7 @@ void CreatureAttributes::consume(Creature* self, CreatureAttributes& other) {
       "more " + t.second.adjective, t.second.absorptionCap);
   consumeAttr(passiveAttack, other.passiveAttack, adjectives, "");
   consumeAttr(gender, other.gender, adjectives);
+  ++version;
   if (!adjectives.empty()) {
     self->you(MsgType::BECOME, combine(adjectives));
     self->addPersonalEvent(getName().the() + " becomes " + combine(adjectives));
@@ -361,15 +395,21 @@ bool CreatureAttributes::isAffectedPermanently(LastingEffect effect) const {
 }
 
 void CreatureAttributes::clearLastingEffect(LastingEffect effect) {
+  // Attacks clear sleep on everyone around, so don't bump the version when there is nothing to clear.
+  if (lastingEffects[effect] == GlobalTime(0))
+    return;
   lastingEffects[effect] = GlobalTime(0);
+  updateActiveLastingEffect(effect);
 }
 
 void CreatureAttributes::addPermanentEffect(LastingEffect effect, int count) {
   permanentEffects[effect] += count;
+  updateActiveLastingEffect(effect);
 }
 
 void CreatureAttributes::removePermanentEffect(LastingEffect effect, int count) {
   permanentEffects[effect] -= count;
+  updateActiveLastingEffect(effect);
 }
 
 const MinionActivityMap& CreatureAttributes::getMinionActivities() const {
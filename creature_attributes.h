@@ -69,7 +69,7 @@ class CreatureAttributes {
   const CreatureName& getName() const;
   CreatureName& getName();
   int getRawAttr(AttrType) const;
-  HashMap<AttrType, int>& getAllAttr();
+  void scaleBaseAttr(double);
   void increaseBaseAttr(AttrType, int);
   void setBaseAttr(AttrType, int);
   void setAIType(AIType);
@@ -106,6 +106,10 @@ class CreatureAttributes {
   bool considerTimeout(LastingEffect, GlobalTime current);
   void addLastingEffect(LastingEffect, GlobalTime endtime);
   optional<GlobalTime> getLastAffected(LastingEffect, GlobalTime currentGlobalTime) const;
+  // Effects with a pending timeout or a permanent count. Nothing outside of it can be active or time out.
+  const EnumSet<LastingEffect>& getActiveLastingEffects() const;
+  // Changes whenever raw attributes, training levels, body parts or lasting effects are modified.
+  int getVersion() const;
   bool canSleep() const;
   bool isInnocent() const;
   void consume(Creature* self, CreatureAttributes& other);
@@ -171,5 +175,9 @@ class CreatureAttributes {
   optional<BuffId> SERIAL(hatedByEffect);
   bool SERIAL(instantPrisoner) = false;
   void initializeLastingEffects();
+  // Rebuilt on first use, since permanentEffects is also filled directly when creating attributes.
+  mutable optional<EnumSet<LastingEffect>> activeLastingEffects;
+  void updateActiveLastingEffect(LastingEffect);
+  int version = 0;
   CreatureInventory SERIAL(inventory);
 };
@@ -54,7 +54,14 @@
 #include "content_factory.h"
 #include "automaton_part.h"
 
-SERIALIZE_DEF(CreatureFactory, nameGenerator, attributes, spellSchools, spells)
+template <class Archive>
+void CreatureFactory::serialize(Archive& ar, const unsigned int) {
+  ar(nameGenerator, attributes, spellSchools, spells);
+  if (Archive::is_loading::value)
+    updateIndex();
+}
+
+SERIALIZABLE(CreatureFactory);
 SERIALIZATION_CONSTRUCTOR_IMPL(CreatureFactory)
 
 class BoulderController : public Monster {
@@ -251,7 +258,7 @@ static ViewId getSpecialViewId(bool humanoid, bool large, bool body, bool wings)
 }
 
 ViewIdList CreatureFactory::getViewId(CreatureId id) const {
-  if (auto a = getReferenceMaybe(attributes, id))
+  if (auto a = attributesIndex.get(id))
     return {a->viewId};
   if (auto p = getReferenceMaybe(getSpecialParams(), id))
     return {getSpecialViewId(p->humanoid, p->large, p->living, p->wings)};
@@ -259,7 +266,7 @@ ViewIdList CreatureFactory::getViewId(CreatureId id) const {
 }
 
 string CreatureFactory::getName(CreatureId id) const {
-  if (auto a = getReferenceMaybe(attributes, id))
+  if (auto a = attributesIndex.get(id))
     return a->name.bare();
   if (auto p = getReferenceMaybe(getSpecialParams(), id))
     return getSpeciesName(p->humanoid, p->large, p->living, p->wings);
@@ -288,13 +295,20 @@ const vector<Spell>& CreatureFactory::getSpells() const {
 
 CreatureFactory::CreatureFactory(NameGenerator n, map<CreatureId, CreatureAttributes> a,
     map<SpellSchoolId, SpellSchool> s, vector<Spell> sp)
-  : nameGenerator(std::move(n)), attributes(a), spellSchools(s), spells(sp) {}
+  : nameGenerator(std::move(n)), attributes(a), spellSchools(s), spells(sp) {
+  updateIndex();
+}
+
+void CreatureFactory::updateIndex() {
+  attributesIndex.build(attributes, [](const CreatureAttributes& a) { return &a; });
+}
 
 CreatureFactory::~CreatureFactory() {
 }
 
 void CreatureFactory::merge(CreatureFactory f) {
   mergeMap(std::move(f.attributes), attributes);
+  updateIndex();
   mergeMap(std::move(f.spellSchools), spellSchools);
   append(spells, std::move(f.spells));
   nameGenerator->merge(std::move(*f.nameGenerator));
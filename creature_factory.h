@@ -94,6 +94,8 @@ class CreatureFactory {
   static PCreature get(CreatureAttributes, TribeId, const ControllerFactory&, SpellMap);
   HeapAllocated<NameGenerator> SERIAL(nameGenerator);
   map<CreatureId, CreatureAttributes> SERIAL(attributes);
+  ContentIdIndex<CreatureId, CreatureAttributes> attributesIndex;
+  void updateIndex();
   vector<ItemType> getDefaultInventory(CreatureId) const;
   map<SpellSchoolId, SpellSchool> SERIAL(spellSchools);
   vector<Spell> SERIAL(spells);
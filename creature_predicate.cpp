@@ -329,6 +329,8 @@ static string getName(const CreaturePredicates::Distance& p, const ContentFactor
 }
 
 static bool apply(const CreaturePredicates::Distance& e, Position pos, const Creature* attacker) {
+  if (!attacker)
+    return false;
   auto dist = attacker->getPosition().dist8(pos).value_or(10000);
   return dist >= e.min.value_or(-1) && dist < e.max.value_or(10000);
 }
@@ -405,9 +407,21 @@ static string getName(const CreaturePredicates::Area& m, const ContentFactory* f
   return m.pred->getNameInternal(f);
 }
 
+// Predicates have no side effects, so And and Or can check the cheap conditions first without changing the result.
+static const vector<int>& getEvaluationOrder(const vector<CreaturePredicate>& preds, vector<int>& order) {
+  if (order.size() != preds.size()) {
+    order.clear();
+    for (int i : All(preds))
+      order.push_back(i);
+    auto costs = preds.transform([](const auto& pred) { return pred.getCost(); });
+    std::stable_sort(order.begin(), order.end(), [&](int i, int j) { return costs[i] < costs[j]; });
+  }
+  return order;
+}
+
 static bool apply(const CreaturePredicates::And& p, Position pos, const Creature* attacker) {
-  for (auto& pred : p.pred)
-    if (!pred.apply(pos, attacker))
+  for (int index : getEvaluationOrder(p.pred, p.evaluationOrder))
+    if (!p.pred[index].apply(pos, attacker))
       return false;
   return true;
 }
@@ -417,8 +431,8 @@ static string getName(const CreaturePredicates::And& p, const ContentFactory* f)
 }
 
 static bool apply(const CreaturePredicates::Or& p, Position pos, const Creature* attacker) {
-  for (auto& pred : p.pred)
-    if (pred.apply(pos, attacker))
+  for (int index : getEvaluationOrder(p.pred, p.evaluationOrder))
+    if (p.pred[index].apply(pos, attacker))
       return true;
   return false;
 }
@@ -427,6 +441,142 @@ static string getName(const CreaturePredicates::Or& p, const ContentFactory* f)
   return combine(p.pred.transform([&] (const auto& pred) { return pred.getNameInternal(f); }), " or "_s);
 }
 
+template <typename T>
+static int getCost(const T&) {
+  return 1;
+}
+
+static int getCost(const CreaturePredicates::Name& p) {
+  return p.pred->getCost();
+}
+
+static int getCost(const CreaturePredicates::Attacker& p) {
+  return p.pred->getCost();
+}
+
+static int getCost(const CreaturePredicates::Not& p) {
+  return p.pred->getCost();
+}
+
+static int getCost(const CreaturePredicates::Translate& p) {
+  return p.pred->getCost();
+}
+
+static int getCost(const CreaturePredicates::Area& p) {
+  return Rectangle::centered(p.radius).area() * p.pred->getCost();
+}
+
+static int getCost(const CreaturePredicates::And& p) {
+  int ret = 0;
+  for (auto& pred : p.pred)
+    ret += pred.getCost();
+  return ret;
+}
+
+static int getCost(const CreaturePredicates::Or& p) {
+  int ret = 0;
+  for (auto& pred : p.pred)
+    ret += pred.getCost();
+  return ret;
+}
+
+static int getCost(const CreaturePredicates::Ingredient&) {
+  return 3;
+}
+
+static int getCost(const CreaturePredicates::OnTheGround&) {
+  return 3;
+}
+
+static int getCost(const CreaturePredicates::InTerritory&) {
+  return 3;
+}
+
+static int getCost(const CreaturePredicates::AttributeAtLeast&) {
+  return 3;
+}
+
+static int getCost(const CreaturePredicates::CanCreatureEnter&) {
+  return 3;
+}
+
+static int getCost(const CreaturePredicates::Spellcaster&) {
+  return 5;
+}
+
+static int getCost(const CreaturePredicates::AIAfraidOf&) {
+  return 5;
+}
+
+static int getCost(const CreaturePredicates::PopLimitReached&) {
+  return 10;
+}
+
+static int getCost(const CreaturePredicates::IsClosedOffPigsty&) {
+  return 20;
+}
+
+template <typename T>
+static bool readsOnlyFixedTraits(const T&) {
+  return false;
+}
+
+static bool readsOnlyFixedTraits(CreatureId) {
+  return true;
+}
+
+static bool readsOnlyFixedTraits(BodyMaterialId) {
+  return true;
+}
+
+static bool readsOnlyFixedTraits(const CreaturePredicates::HatedBy&) {
+  return true;
+}
+
+static bool readsOnlyFixedTraits(const CreaturePredicates::Name&);
+static bool readsOnlyFixedTraits(const CreaturePredicates::Not&);
+static bool readsOnlyFixedTraits(const CreaturePredicates::And&);
+static bool readsOnlyFixedTraits(const CreaturePredicates::Or&);
+
+static bool readsOnlyFixedTraits(const CreaturePredicate& p) {
+  return p.visit<bool>([&](const auto& p) { return readsOnlyFixedTraits(p); });
+}
+
+static bool readsOnlyFixedTraits(const CreaturePredicates::Name& p) {
+  return readsOnlyFixedTraits(*p.pred);
+}
+
+static bool readsOnlyFixedTraits(const CreaturePredicates::Not& p) {
+  return readsOnlyFixedTraits(*p.pred);
+}
+
+static bool readsOnlyFixedTraits(const CreaturePredicates::And& p) {
+  for (auto& pred : p.pred)
+    if (!readsOnlyFixedTraits(pred))
+      return false;
+  return true;
+}
+
+static bool readsOnlyFixedTraits(const CreaturePredicates::Or& p) {
+  for (auto& pred : p.pred)
+    if (!readsOnlyFixedTraits(pred))
+      return false;
+  return true;
+}
+
+template <typename T>
+static bool isCompound(const T&) {
+  return false;
+}
+
+static bool isCompound(const CreaturePredicates::And&) {
+  return true;
+}
+
+static bool isCompound(const CreaturePredicates::Or&) {
+  return true;
+}
+
 template <typename T>
 static string getNameNegated(const T& p, const ContentFactory* f) {
   return "not " + Impl::getName(p, f);
@@ -456,14 +606,46 @@ static bool applyToCreature1(const T& t, const Creature* c, const Creature* atta
   return Impl::apply(t, c->getPosition(), attacker);
 }
 
-bool CreaturePredicate::apply(Position pos, const Creature* attacker) const {
+bool CreaturePredicate::applyInternal(Position pos, const Creature* attacker) const {
   return visit<bool>([&](const auto& p) { return Impl::apply(p, pos, attacker); });
 }
 
+// Smaller trees are cheaper to evaluate than to look up.
+const int minCachedTraitCost = 3;
+// Dead and departed creatures are never evicted one by one, so the whole cache is dropped when it grows this big.
+const int maxCachedTraitEntries = 2000;
+
+bool CreaturePredicate::apply(Position pos, const Creature* attacker) const {
+  if (!cachedByTraits) {
+    cachedByTraits = visit<bool>([&](const auto& p) { return Impl::isCompound(p) && Impl::readsOnlyFixedTraits(p); })
+        && getCost() >= minCachedTraitCost;
+    if (*cachedByTraits)
+      traitCache = make_shared<HashMap<GenericId, pair<int, bool>>>();
+  }
+  if (*cachedByTraits)
+    if (auto c = pos.getCreature()) {
+      auto id = c->getUniqueId().getGenericId();
+      auto generation = c->getAttributesGeneration();
+      auto it = traitCache->find(id);
+      if (it != traitCache->end() && it->second.first == generation)
+        return it->second.second;
+      auto ret = applyInternal(pos, attacker);
+      if (it == traitCache->end() && traitCache->size() >= maxCachedTraitEntries)
+        traitCache->clear();
+      (*traitCache)[id] = make_pair(generation, ret);
+      return ret;
+    }
+  return applyInternal(pos, attacker);
+}
+
 bool CreaturePredicate::apply(Creature* c, const Creature* attacker) const {
   return visit<bool>([&](const auto& p) { return applyToCreature1(p, c, attacker, 1); });
 }
 
+int CreaturePredicate::getCost() const {
+  return visit<int>([&](const auto& p) { return Impl::getCost(p); });
+}
+
 string CreaturePredicate::getName(const ContentFactory* f) const {
   return visit<string>([&](const auto& p) { return Impl::getNameTopLevel(p, f); });
 }
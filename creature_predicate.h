@@ -9,6 +9,7 @@
 #include "body_material_id.h"
 #include "attr_type.h"
 #include "tile_gas_type.h"
+#include "unique_entity.h"
 
 #define SIMPLE_PREDICATE(Name) \
   struct Name { \
@@ -91,13 +92,19 @@ struct Not {
   SERIALIZE_ALL(pred)
 };
 
+// The declared order of pred carries no meaning, conditions are checked from the cheapest.
 struct And {
   vector<CreaturePredicate> SERIAL(pred);
+  // Indexes of pred from the cheapest to evaluate. Filled on first use.
+  mutable vector<int> evaluationOrder;
   SERIALIZE_ALL(pred)
 };
 
+// The declared order of pred carries no meaning, conditions are checked from the cheapest.
 struct Or {
   vector<CreaturePredicate> SERIAL(pred);
+  // Indexes of pred from the cheapest to evaluate. Filled on first use.
+  mutable vector<int> evaluationOrder;
   SERIALIZE_ALL(pred)
 };
 
@@ -203,4 +210,13 @@ struct CreaturePredicate : CreaturePredicates::CreaturePredicate {
   bool apply(Creature*, const Creature* attacker) const;
   string getName(const ContentFactory*) const;
   string getNameInternal(const ContentFactory*, bool negated = false) const;
+  // Rough relative cost of apply, computed from the predicate tree.
+  int getCost() const;
+
+  private:
+  bool applyInternal(Position, const Creature* attacker) const;
+  // And and Or trees that only read traits fixed for the lifetime of the creature's attributes
+  // remember their result per creature. Decided on first use.
+  mutable optional<bool> cachedByTraits;
+  mutable shared_ptr<HashMap<GenericId, pair<int, bool>>> traitCache;
 };
@@ -137,6 +137,7 @@ static bool enhanceArmor(Creature* c, int mod, const string& msg) {
         c->you(MsgType::YOUR, item->getName() + " " + msg);
         if (item->getModifier(AttrType("DEFENSE")) > 0 || mod > 0)
           item->addModifier(AttrType("DEFENSE"), mod);
+        c->clearAttrCache();
         return true;
       }
   return false;
@@ -146,6 +147,7 @@ static bool enhanceWeapon(Creature* c, int mod, const string& msg) {
   if (auto item = c->getFirstWeapon()) {
     c->you(MsgType::YOUR, item->getName() + " " + msg);
     item->addModifier(item->getWeaponInfo().meleeAttackAttr, mod);
+    c->clearAttrCache();
     return true;
   }
   return false;
@@ -2602,6 +2604,52 @@ EffectAIIntent Effect::shouldAIApply(const Creature* caster, Position pos) const
   });
 }
 
+// Must agree with the shouldAIApply overloads above: types that never return a non-zero intent map to false.
+static bool canAIApply(const DefaultType&) {
+  return false;
+}
+
+template <typename T, REQUIRE(shouldAIApplyToCreature(TVALUE(const T&), TVALUE(const Creature*), TVALUE(bool)))>
+static bool canAIApply(const T&) {
+  return true;
+}
+
+static bool canAIApply(const Effects::GenericModifierEffect& e) {
+  return e.effect->getAIInfo().canApply;
+}
+
+static bool canAIApply(const Effects::Chain& chain) {
+  for (auto& e : chain.effects)
+    if (e.getAIInfo().canApply)
+      return true;
+  return false;
+}
+
+static bool canAIApply(const Effects::AI&) {
+  return true;
+}
+
+static bool canAIApply(const Effects::EmitGas&) {
+  return true;
+}
+
+static bool canAIApply(const Effects::Wish&) {
+  return true;
+}
+
+static bool canAIApply(const Effects::AnimateItems&) {
+  return true;
+}
+
+const Effect::AIInfo& Effect::getAIInfo() const {
+  if (!aiInfo)
+    aiInfo = AIInfo{
+      isOffensive(),
+      effect->visit<bool>([](const auto& e) { return ::canAIApply(e); })
+    };
+  return *aiInfo;
+}
+
 static optional<FXInfo> getProjectileFX(const DefaultType&) {
   return none;
 }
@@ -2700,6 +2748,7 @@ static void scale(const DefaultType& e, double, const ContentFactory*) {
 }
 
 void Effect::scale(double value, const ContentFactory* f) {
+  aiInfo = none;
   effect->visit<void>([f, value](auto& elem) { ::scale(elem, value, f); });
 }
 
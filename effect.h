@@ -57,6 +57,15 @@ class Effect {
 
   EffectAIIntent shouldAIApply(const Creature* caster, Position) const;
 
+  // Properties that the AI checks for every carried item and spell. They only depend on the effect type tree,
+  // so they are computed once per effect.
+  struct AIInfo {
+    bool offensive;
+    // False if shouldAIApply returns 0 regardless of the caster and position.
+    bool canApply;
+  };
+  const AIInfo& getAIInfo() const;
+
   static vector<Creature*> summon(Creature*, CreatureId, int num, optional<TimeInterval> ttl, TimeInterval delay = 0_visible,
       optional<Position> = none);
   static vector<Creature*> summon(Position, CreatureGroup&, int num, optional<TimeInterval> ttl, TimeInterval delay = 0_visible);
@@ -66,6 +75,9 @@ class Effect {
   static void enhanceArmor(Creature*, int mod, const string& msg);
 
   HeapAllocated<EffectType> SERIAL(effect);
+
+  private:
+  mutable optional<AIInfo> aiInfo;
 };
 
 static_assert(std::is_nothrow_move_constructible<Effect>::value, "T should be noexcept MoveConstructible");
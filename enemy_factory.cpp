@@ -72,7 +72,7 @@ void EnemyFactory::updateCreateOnBones(EnemyInfo& info) const {
     EnemyInfo enemy = get(random.choose(info.createOnBones->enemies));
     info.levelConnection = enemy.levelConnection;
     info.biome = enemy.biome;
-    bool makeRuins = Random.roll(2);
+    bool makeRuins = random.roll(2);
     if (makeRuins) {
       if (auto builtin = info.settlement.type.getReferenceMaybe<MapLayoutTypes::Builtin>())
         builtin->buildingId = BuildingId("RUINS");
@@ -97,6 +97,7 @@ bool Equipment::canEquip(const Item* item, const Creature* c) const {
 void Equipment::equip(Item* item, EquipmentSlot slot, Creature* c, const ContentFactory* factory) {
   items[slot].push_back(item);
   equipped.push_back(item);
+  ++version;
   item->onEquip(c, true, factory);
   CHECK(inventory.hasItem(item));
 }
@@ -104,9 +105,14 @@ void Equipment::equip(Item* item, EquipmentSlot slot, Creature* c, const Content
 void Equipment::unequip(Item* item, Creature* c, const ContentFactory* factory) {
   items[item->getEquipmentSlot()].removeElement(item);
   equipped.removeElement(item);
+  ++version;
   item->onUnequip(c, true, factory);
 }
 
+int Equipment::getVersion() const {
+  return version;
+}
+
 void Equipment::onRemoved(Item* item, Creature* c, const ContentFactory* factory) {
   if (isEquipped(item))
     unequip(item, c, factory);
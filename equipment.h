@@ -45,6 +45,8 @@ class Equipment {
   const ItemCounts& getCounts() const;
   void tick(Position, Creature*);
   bool containsAnyOf(const EntitySet<Item>&) const;
+  // Changes whenever an item is equipped or unequipped.
+  int getVersion() const;
 
   SERIALIZATION_DECL(Equipment)
 
@@ -55,5 +57,6 @@ class Equipment {
   EnumMap<EquipmentSlot, vector<Item*>> SERIAL(items);
   vector<Item*> SERIAL(equipped);
   void onRemoved(Item*, Creature*, const ContentFactory*);
+  int version = 0;
 };
 
@@ -30,3 +30,29 @@ void FurnitureArray::eraseConstruction(Vec2 pos, FurnitureLayer layer) {
 void FurnitureArray::setConstruction(Vec2 pos, FurnitureLayer layer, FurnitureArray::Construction c) {
   construction[layer][pos] = c;
 }
+
+void FurnitureArray::sharePrototypes(const FurnitureArray& other) {
+  for (auto layer : ENUM_ALL(FurnitureLayer))
+    built[layer].sharePrototypes(other.built[layer]);
+}
+
+long long FurnitureArray::getMemoryUsage() const {
+  long long ret = 0;
+  for (auto layer : ENUM_ALL(FurnitureLayer))
+    ret += built[layer].getMemoryUsage() + construction[layer].size() * (sizeof(Vec2) + sizeof(Construction));
+  return ret;
+}
+
+long long FurnitureArray::getSharedMemoryUsage() const {
+  long long ret = 0;
+  for (auto layer : ENUM_ALL(FurnitureLayer))
+    ret += built[layer].getPrototypes().getMemoryUsage();
+  return ret;
+}
+
+int FurnitureArray::getNumModified() const {
+  int ret = 0;
+  for (auto layer : ENUM_ALL(FurnitureLayer))
+    ret += built[layer].getNumModified();
+  return ret;
+}
@@ -28,6 +28,13 @@ class FurnitureArray {
   void eraseConstruction(Vec2, FurnitureLayer);
   void setConstruction(Vec2, FurnitureLayer, Construction);
 
+  // Makes this array use the unmodified furniture of the other one, so they're kept in memory once.
+  void sharePrototypes(const FurnitureArray&);
+  // Approximate number of bytes, excluding the shared unmodified furniture.
+  long long getMemoryUsage() const;
+  long long getSharedMemoryUsage() const;
+  int getNumModified() const;
+
   SERIALIZATION_DECL(FurnitureArray)
 
   private:
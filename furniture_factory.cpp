@@ -20,7 +20,14 @@
 #include "furniture_on_built.h"
 #include "game_config.h"
 
-SERIALIZE_DEF(FurnitureFactory, furniture, furnitureLists, trainingFurniture, upgrades, bedFurniture, needingLight, increasingPopulation, constructionObjects)
+template <class Archive>
+void FurnitureFactory::serialize(Archive& ar, const unsigned int) {
+  ar(furniture, furnitureLists, trainingFurniture, upgrades, bedFurniture, needingLight, increasingPopulation, constructionObjects);
+  if (Archive::is_loading::value)
+    updateIndex();
+}
+
+SERIALIZABLE(FurnitureFactory);
 SERIALIZATION_CONSTRUCTOR_IMPL(FurnitureFactory)
 
 bool FurnitureParams::operator == (const FurnitureParams& p) const {
@@ -45,8 +52,8 @@ PFurniture FurnitureFactory::getFurniture(FurnitureType type, TribeId tribe) con
 }
 
 const Furniture& FurnitureFactory::getData(FurnitureType type) const {
-  if (auto ret = getReferenceMaybe(furniture, type))
-    return **ret;
+  if (auto ret = furnitureIndex.get(type))
+    return *ret;
   FATAL << "Furniture not found " << type.data();
   fail();
 }
@@ -57,10 +64,16 @@ const ViewObject& FurnitureFactory::getConstructionObject(FurnitureType type) co
 
 void FurnitureFactory::merge(FurnitureFactory f) {
   mergeMap(std::move(f.furniture), furniture);
+  updateIndex();
+}
+
+void FurnitureFactory::updateIndex() {
+  furnitureIndex.build(furniture, [](const unique_ptr<Furniture>& f) { return f.get(); });
 }
 
 FurnitureFactory::FurnitureFactory(map<FurnitureType, unique_ptr<Furniture> > f, map<FurnitureListId, FurnitureList> l)
     : furniture(std::move(f)), furnitureLists(std::move(l)) {
+  updateIndex();
 }
 
 void FurnitureFactory::initializeInfos() {
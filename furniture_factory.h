@@ -56,6 +56,8 @@ class FurnitureFactory {
   vector<FurnitureType> SERIAL(increasingPopulation);
   EnumMap<BedType, vector<FurnitureType>> SERIAL(bedFurniture);
   HashMap<FurnitureType, ViewObject> SERIAL(constructionObjects);
+  ContentIdIndex<FurnitureType, Furniture> furnitureIndex;
+  void updateIndex();
 };
 
 static_assert(std::is_nothrow_move_constructible<FurnitureFactory>::value, "T should be noexcept MoveConstructible");
@@ -313,8 +313,8 @@ void Game::prepareSiteRetirement() {
           if (c->getPosition().getModel() == mainModel)
             transferCreature(c, models[v].get());
   mainModel->prepareForRetirement();
-  UniqueEntity<Item>::offsetForSerialization(Random.getLL());
-  UniqueEntity<Creature>::offsetForSerialization(Random.getLL());
+  UniqueEntity<Item>::offsetForSerialization(IdRandom.getLL());
+  UniqueEntity<Creature>::offsetForSerialization(IdRandom.getLL());
 }
 
 void Game::doneRetirement() {
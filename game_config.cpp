@@ -87,3 +87,36 @@ const char* GameConfig::getConfigName(GameConfigId id) {
 
 GameConfig::GameConfig(vector<DirectoryPath> modDirs) : dirs(std::move(modDirs)) {
 }
+
+vector<FilePath> GameConfig::getPaths(GameConfigId id) const {
+  vector<FilePath> paths;
+  string fileName = getConfigName(id) + ".txt"_s;
+  for (auto& dir : dirs) {
+    auto path = dir.file(fileName);
+    if (path.exists())
+      paths.push_back(std::move(path));
+  }
+  return paths;
+}
+
+void GameConfig::preprocessAll() const {
+  const int numIds = EnumInfo<GameConfigId>::size;
+  vector<optional<PrettyInput>> results(numIds);
+  atomic<int> nextId(0);
+  auto preprocessFiles = [&] {
+    for (int i = nextId++; i < numIds; i = nextId++) {
+      PrettyInput input;
+      if (!PrettyPrinting::preprocess(getPaths(GameConfigId(i)), input))
+        results[i] = std::move(input);
+    }
+  };
+  vector<std::thread> threads;
+  for (int i : Range(min<int>(numIds, std::thread::hardware_concurrency()) - 1))
+    threads.push_back(std::thread(preprocessFiles));
+  preprocessFiles();
+  for (auto& t : threads)
+    t.join();
+  for (int i : Range(numIds))
+    if (results[i])
+      preprocessed[GameConfigId(i)] = std::move(*results[i]);
+}
@@ -49,6 +49,8 @@ void Item::serialize(Archive& ar, const unsigned int version) {
 SERIALIZABLE(Item)
 SERIALIZATION_CONSTRUCTOR_IMPL(Item)
 
+SLAB_ALLOCATED_IMPL(Item)
+
 Item::Item(const ItemAttributes& attr, const ContentFactory* factory)
     : Renderable(ViewObject(attr.viewId, ViewLayer::ITEM, capitalFirst(attr.name))),
       attributes(attr), fire(attr.burnTime), canEquipCache(!!attributes->equipmentSlot),
@@ -23,6 +23,7 @@
 #include "owner_pointer.h"
 #include "game_time.h"
 #include "item_ability.h"
+#include "slab_allocator.h"
 
 class Level;
 class Attack;
@@ -142,6 +143,7 @@ class Item : public Renderable, public UniqueEntity<Item>, public OwnedObject<It
   virtual optional<CorpseInfo> getCorpseInfo() const;
 
   SERIALIZATION_DECL(Item)
+  SLAB_ALLOCATED(Item)
 
   protected:
   virtual void specialTick(Position) {}
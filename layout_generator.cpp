@@ -247,19 +247,25 @@ bool make(const LayoutGenerators::NoiseMap& g, LayoutCanvas c, RandomGen& r) {
   if (c.area.empty())
     return true;
   auto map = genNoiseMap(r, c.area, NoiseInit { 1, 1, 1, 1, 1 }, g.exponent);
-  vector<double> all;
-  auto getValue = [&all](double r) {
-    int index = max(0, int(r * all.size()));
-    if (index >= all.size())
-      return all.back() + 1;
-    return all[index];
-  };
-  for (auto v : map.getBounds())
-    all.push_back(map[v]);
-  sort(all.begin(), all.end());
+  const int numValues = c.area.area();
+  // Thresholds of 1 or more are placed above the maximum value, so that every tile is below them.
+  auto getIndex = [&](double r) { return min(numValues - 1, max(0, int(r * numValues))); };
+  vector<int> indices;
   for (auto& generator : g.generators) {
-    auto lower = getValue(generator.lower);
-    auto upper = getValue(generator.upper);
+    indices.push_back(getIndex(generator.lower));
+    indices.push_back(getIndex(generator.upper));
+  }
+  indices.push_back(numValues - 1);
+  auto sortedValues = getSortedValues(map, indices);
+  auto getValue = [&](double r, int index) {
+    if (max(0, int(r * numValues)) >= numValues)
+      return sortedValues.back() + 1;
+    return sortedValues[index];
+  };
+  for (int i : All(g.generators)) {
+    auto& generator = g.generators[i];
+    auto lower = getValue(generator.lower, 2 * i);
+    auto upper = getValue(generator.upper, 2 * i + 1);
     for (auto v : c.area)
       if (map[v] >= lower && map[v] < upper)
         if (!generator.generator->make(c.with(Rectangle(v, v + Vec2(1, 1))), r))
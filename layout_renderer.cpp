@@ -83,12 +83,17 @@ void renderAscii(const LayoutCanvas::Map& map1, istream& file) {
   }
 }
 
-void generateMapLayout(const MainLoop& mainLoop, const string& layoutName, FilePath glyphPath,
-    const string& layoutSizeString) {
+static Vec2 parseLayoutSize(const string& layoutSizeString) {
   auto layoutSizeSplit = split(layoutSizeString, {':'});
   USER_CHECK(layoutSizeSplit.size() == 2) << "Bad layout size " << layoutSizeString;
   auto layoutSize = Vec2(fromString<int>(layoutSizeSplit[0]), fromString<int>(layoutSizeSplit[1]));
   USER_CHECK(layoutSize.x >= 1 && layoutSize.y >= 1) << "Bad layout size " << layoutSize;
+  return layoutSize;
+}
+
+void generateMapLayout(const MainLoop& mainLoop, const string& layoutName, FilePath glyphPath,
+    const string& layoutSizeString) {
+  auto layoutSize = parseLayoutSize(layoutSizeString);
   auto glyphFile = ifstream(glyphPath.getPath());
   USER_CHECK(!!glyphFile) << "Failed to open glyph file, check the layout_glyphs flag";
   auto factory = mainLoop.createContentFactory(false);
@@ -98,3 +103,30 @@ void generateMapLayout(const MainLoop& mainLoop, const string& layoutName, FileP
   USER_CHECK(!!generator.make(LayoutCanvas{map.elems.getBounds(), &map}, Random)) << "Generation failed";
   renderAscii(map, glyphFile);
 }
+
+void benchmarkMapLayouts(const MainLoop& mainLoop, const string& layoutName, const string& layoutSizeString,
+    int numRuns) {
+  using namespace std::chrono;
+  auto layoutSize = parseLayoutSize(layoutSizeString);
+  auto factory = mainLoop.createContentFactory(false);
+  vector<RandomLayoutId> ids;
+  if (layoutName == "all")
+    ids = getKeys(factory.randomLayouts);
+  else {
+    USER_CHECK(factory.randomLayouts.count(RandomLayoutId(layoutName.data()))) << "Layout not found: " << layoutName;
+    ids.push_back(RandomLayoutId(layoutName.data()));
+  }
+  for (auto id : ids) {
+    auto& generator = factory.randomLayouts.at(id);
+    int numFailed = 0;
+    auto time = steady_clock::now();
+    for (int i : Range(numRuns)) {
+      LayoutCanvas::Map map{ Table<vector<Token>>(layoutSize) };
+      if (!generator.make(LayoutCanvas{map.elems.getBounds(), &map}, Random))
+        ++numFailed;
+    }
+    double seconds = max<double>(1, duration_cast<microseconds>(steady_clock::now() - time).count()) / 1000000;
+    std::cout << id.data() << ": " << numRuns << " runs, " << numFailed << " failed, "
+        << int(numRuns * layoutSize.x * layoutSize.y / seconds) << " tiles/sec" << std::endl;
+  }
+}
@@ -8,3 +8,5 @@ class MainLoop;
 
 void renderAscii(const LayoutCanvas::Map&, istream& file);
 void generateMapLayout(const MainLoop&, const string& layoutName, FilePath glyphPath, const string& layoutSize);
+// Times the generator on numRuns empty maps and prints tiles generated per second. Pass "all" to run every layout.
+void benchmarkMapLayouts(const MainLoop&, const string& layoutName, const string& layoutSize, int numRuns);
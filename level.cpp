@@ -46,6 +46,9 @@
 #include "known_tiles.h"
 #include "territory.h"
 #include "player_control.h"
+#include "tile_gas.h"
+#include "light_map.h"
+#include "tile_sampler.h"
 
 template <class Archive>
 void Level::serialize(Archive& ar, const unsigned int version) {
@@ -53,9 +56,9 @@ void Level::serialize(Archive& ar, const unsigned int version) {
     CHECK(!model->serializationLocked);
   ar & SUBCLASS(OwnedObject<Level>);
   ar(squares, landingSquares, tickingSquares, creatures, model, fieldOfView);
-  ar(sunlight, bucketMap, lightAmount, unavailable, swarmMaps, territory);
-  ar(levelId, noDiagonalPassing, lightCapAmount, creatureIds, memoryUpdates, above, below, mountainLevel);
-  ar(furniture, tickingFurniture, covered, name, depth, wildlife, addedWildlife, mainDungeon);
+  ar(sunlight, bucketMap, lightMap, unavailable, swarmMaps, territory);
+  ar(levelId, noDiagonalPassing, creatureIds, memoryUpdates, above, below, mountainLevel);
+  ar(furniture, tickingFurniture, covered, name, depth, wildlife, addedWildlife, mainDungeon, tileGas);
   vector<pair<TribeId, unique_ptr<EffectsTable>>> SERIAL(tmp);
   for (auto t : ENUM_ALL(TribeId::KeyType))
     if (!!furnitureEffects[t])
@@ -92,13 +95,15 @@ Level::Level(Private, SquareArray s, FurnitureArray f, Model* m, Table<double> s
       sunlight(sun),
       bucketMap(squares->getBounds().getSize(), FieldOfView::sightRange),
       swarmMaps(getSwarmMaps(squares->getBounds().getSize())),
-      lightAmount(squares->getBounds(), 0), lightCapAmount(squares->getBounds(), 1),
+      lightMap(this, squares->getBounds()),
       levelId(id) {
 }
 
 PLevel Level::create(SquareArray s, FurnitureArray f, Model* m,
-    Table<double> sun, LevelId id, Table<bool> covered, Table<bool> unavailable, const ContentFactory* factory) {
+    Table<double> sun, LevelId id, Table<bool> covered, Table<bool> unavailable, TileGas gas,
+    const ContentFactory* factory) {
   auto ret = makeOwner<Level>(Private{}, std::move(s), std::move(f), m, sun, id);
+  ret->tileGas.reset(std::move(gas));
   for (Vec2 pos : ret->squares->getBounds()) {
     auto square = ret->squares->getReadonly(pos);
     square->onAddedToLevel(Position(pos, ret.get()));
@@ -160,28 +165,11 @@ void Level::removeLightSource(Vec2 pos, double radius) {
 
 void Level::addLightSource(Vec2 pos, double radius, int numLight) {
   PROFILE;
-  if (radius > 0) {
-    for (Vec2 v : getVisibleTilesNoDarkness(pos, VisionId::NORMAL)) {
-      double dist = (v - pos).lengthD();
-      if (dist <= radius) {
-        lightAmount[v] += min(1.0, 1 - (dist) / radius) * numLight;
-        setNeedsRenderUpdate(v, true);
-      }
-    }
-  }
+  lightMap->addLightSource(pos, radius, numLight, getFieldOfView(VisionId::NORMAL));
 }
 
 void Level::addDarknessSource(Vec2 pos, double radius, int numDarkness) {
-  if (radius > 0) {
-    for (Vec2 v : getVisibleTilesNoDarkness(pos, VisionId::NORMAL)) {
-      double dist = (v - pos).lengthD();
-      if (dist <= radius) {
-        lightCapAmount[v] -= min(1.0, 1 - (dist) / radius) * numDarkness;
-        setNeedsRenderUpdate(v, true);
-      }
-//      updateConnectivity(v);
-    }
-  }
+  lightMap->addDarknessSource(pos, radius, numDarkness, getFieldOfView(VisionId::NORMAL));
 }
 
 void Level::updateCreatureLight(Vec2 pos, int diff) {
@@ -197,16 +185,10 @@ void Level::updateCreatureLight(Vec2 pos, int diff) {
 
 void Level::updateVisibility(Vec2 changedSquare) {
   auto allVisible = getVisibleTilesNoDarkness(changedSquare, VisionId::NORMAL);
-  for (Vec2 pos : allVisible) {
-    addLightSource(pos, Position(pos, this).getLightEmission(), -1);
-    updateCreatureLight(pos, -1);
-  }
+  auto lightSources = lightMap->detachSources(changedSquare);
   for (VisionId vision : ENUM_ALL(VisionId))
     getFieldOfView(vision).squareChanged(changedSquare);
-  for (Vec2 pos : allVisible) {
-    addLightSource(pos, Position(pos, this).getLightEmission(), 1);
-    updateCreatureLight(pos, 1);
-  }
+  lightMap->attachSources(lightSources, getFieldOfView(VisionId::NORMAL));
   for (Vec2 pos : allVisible)
     getModel()->addEvent(EventInfo::VisibilityChanged{Position(pos, this)});
 }
@@ -226,7 +208,7 @@ Game* Level::getGame() const {
 }
 
 double Level::getLight(Vec2 pos) const {
-  return min(1.0, max(0.0, min(covered[pos] ? 1.0 : lightCapAmount[pos], lightAmount[pos] +
+  return min(1.0, max(0.0, min(covered[pos] ? 1.0 : lightMap->getLightCapAmount(pos), lightMap->getLightAmount(pos) +
       sunlight[pos] * getGame()->getSunlightInfo().getLightAmount())));
 }
 
@@ -529,6 +511,17 @@ vector<Position> Level::getAllLandingPositions() const {
   });
 }
 
+vector<Position> Level::getRandomUncoveredPositions(int count) const {
+  if (!uncoveredTiles) {
+    uncoveredTiles = make_unique<TileSampler>(getBounds());
+    for (auto pos : getAllPositions())
+      if (!pos.isCovered())
+        uncoveredTiles->insert(pos.getCoord());
+  }
+  return uncoveredTiles->getRandom(Random, count).transform(
+      [this](Vec2 v) { return Position(v, getThis().removeConst().get()); });
+}
+
 void Level::addTickingSquare(Vec2 pos) {
   tickingSquares.insert(pos);
 }
@@ -545,6 +538,7 @@ void Level::tick() {
     for (auto layer : ENUM_ALL(FurnitureLayer))
       if (auto f = furniture->getBuilt(layer).getWritable(pos))
         f->tick(Position(pos, this), layer);
+  tileGas->tick(this);
   addedWildlife = addedWildlife.filter([this, col = getGame()->getPlayerCollective()](Creature* c) {
     return c->getPosition().getLevel() == this && (!col || !col->getCreatures().contains(c)); });
   if (Random.roll(50) && addedWildlife.size() < wildlife.count.getStart()) {
@@ -554,30 +548,58 @@ void Level::tick() {
       auto c = std::move(gen[0]);
       c->getStatus().insert(CreatureStatus::CIVILIAN);
       auto ref = c.get();
-      auto positions = getAllPositions().filter([](auto pos) { return !pos.isCovered(); });
+      auto positions = getRandomUncoveredPositions(10);
       if (!positions.empty() && getModel()->landCreature(positions, std::move(c)))
         addedWildlife.push_back(ref);
     }
   }
   if (above) {
     PROFILE_BLOCK("Z level tick");
-    for (auto v : getBounds()) {
-      if (!unavailable[v] && above->unavailable[v]) {
-        Position pos(v, this);
-        if (pos.isCovered()) {
-          Position abovePos(v, above);
-          auto col = getGame()->getPlayerCollective();
-          above->unavailable[v] = false;
-          abovePos.addFurniture(getGame()->getContentFactory()->furniture.getFurniture(FurnitureType("ROOF"),
-              TribeId::getMonster()));
-          if (!!col && col->getKnownTiles().isKnown(pos)) {
-            col->addKnownTile(abovePos);
-            getGame()->getPlayerControl()->addToMemory(abovePos);
-          }
-          if (!!col && col->getTerritory().contains(pos))
-            col->claimSquare(abovePos);
-        }
+    if (zLevelUpdateAll) {
+      zLevelUpdateAll = false;
+      zLevelUpdates.clear();
+      for (auto v : getBounds())
+        updateZLevel(v);
+    } else {
+      auto updates = std::move(zLevelUpdates);
+      zLevelUpdates.clear();
+      for (auto v : updates)
+        updateZLevel(v);
+    }
+  }
+}
+
+void Level::addZLevelUpdate(Vec2 v) {
+  if (!zLevelUpdateAll)
+    zLevelUpdates.push_back(v);
+}
+
+void Level::onFurnitureChanged(Vec2 v) {
+  addZLevelUpdate(v);
+  if (uncoveredTiles) {
+    if (Position(v, this).isCovered())
+      uncoveredTiles->erase(v);
+    else
+      uncoveredTiles->insert(v);
+  }
+}
+
+void Level::updateZLevel(Vec2 v) {
+  if (!unavailable[v] && above->unavailable[v]) {
+    Position pos(v, this);
+    if (pos.isCovered()) {
+      Position abovePos(v, above);
+      auto col = getGame()->getPlayerCollective();
+      above->unavailable[v] = false;
+      above->addZLevelUpdate(v);
+      abovePos.addFurniture(getGame()->getContentFactory()->furniture.getFurniture(FurnitureType("ROOF"),
+          TribeId::getMonster()));
+      if (!!col && col->getKnownTiles().isKnown(pos)) {
+        col->addKnownTile(abovePos);
+        getGame()->getPlayerControl()->addToMemory(abovePos);
       }
+      if (!!col && col->getTerritory().contains(pos))
+        col->claimSquare(abovePos);
     }
   }
 }
@@ -640,6 +662,11 @@ int Level::getNumTotalSquares() const {
   return squares->getNumGenerated();
 }
 
+Level::MemoryUsage Level::getMemoryUsage() const {
+  return MemoryUsage{squares->getMemoryUsage() + furniture->getMemoryUsage(), furniture->getSharedMemoryUsage(),
+      furniture->getNumModified()};
+}
+
 void Level::setNeedsMemoryUpdate(Vec2 pos, bool s) {
   memoryUpdates[pos] = s;
   if (s)
@@ -665,6 +692,7 @@ void Level::setFurniture(Vec2 pos, PFurniture f) {
   if (f->isTicking())
     addTickingFurniture(pos);
   furniture->getBuilt(layer).putElem(pos, std::move(f));
+  onFurnitureChanged(pos);
 }
 
 vector<PhylacteryInfo> Level::getPhylacteries() {
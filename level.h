@@ -45,6 +45,9 @@ class FurnitureArray;
 class Vision;
 class FieldOfView;
 class ContentFactory;
+class TileGas;
+class TileSampler;
+class LightMap;
 struct PhylacteryInfo;
 
 /** A class representing a single level of the dungeon or the overworld. All events occuring on the level are performed by this class.*/
@@ -101,6 +104,8 @@ class Level : public OwnedObject<Level> {
 
   vector<Position> getAllPositions() const;
   vector<Position> getAllLandingPositions() const;
+  // Returns up to count distinct random positions that aren't covered.
+  vector<Position> getRandomUncoveredPositions(int count) const;
 
   void addTickingSquare(Vec2 pos);
   void addTickingFurniture(Vec2 pos);
@@ -141,6 +146,13 @@ class Level : public OwnedObject<Level> {
 
   int getNumGeneratedSquares() const;
   int getNumTotalSquares() const;
+  struct MemoryUsage {
+    // Approximate number of bytes taken by squares and furniture, without the furniture shared with other levels.
+    long long tiles;
+    long long sharedFurniture;
+    int numModifiedFurniture;
+  };
+  MemoryUsage getMemoryUsage() const;
 
   void setNeedsMemoryUpdate(Vec2, bool);
   bool needsMemoryUpdate(Vec2) const;
@@ -179,12 +191,22 @@ class Level : public OwnedObject<Level> {
   Square* modSafeSquare(Vec2);
   HeapAllocated<SquareArray> SERIAL(squares);
   HeapAllocated<FurnitureArray> SERIAL(furniture);
+  HeapAllocated<TileGas> SERIAL(tileGas);
   Table<bool> SERIAL(memoryUpdates);
   Table<bool> renderUpdates = Table<bool>(getMaxBounds(), true);
   Table<bool> SERIAL(unavailable);
   LandingSquares SERIAL(landingSquares);
   set<Vec2> SERIAL(tickingSquares);
   set<Vec2> SERIAL(tickingFurniture);
+  // Tiles whose furniture or availability changed, to check if they open up the tile above. Everything is checked
+  // after creating or loading the level.
+  vector<Vec2> zLevelUpdates;
+  bool zLevelUpdateAll = true;
+  void addZLevelUpdate(Vec2);
+  void updateZLevel(Vec2);
+  // Built on first use and updated when furniture changes.
+  mutable unique_ptr<TileSampler> uncoveredTiles;
+  void onFurnitureChanged(Vec2);
   void placeCreature(Creature*, Vec2 pos);
   void unplaceCreature(Creature*, Vec2 pos);
   vector<Creature*> SERIAL(creatures);
@@ -195,8 +217,7 @@ class Level : public OwnedObject<Level> {
   Table<bool> SERIAL(covered);
   HeapAllocated<CreatureBucketMap> SERIAL(bucketMap);
   vector<pair<int, CreatureBucketMap>> SERIAL(swarmMaps);
-  Table<double> SERIAL(lightAmount);
-  Table<double> SERIAL(lightCapAmount);
+  HeapAllocated<LightMap> SERIAL(lightMap);
   EnumMap<TribeId::KeyType, unique_ptr<EffectsTable>> SERIAL(furnitureEffects);
   mutable HashMap<MovementType, Sectors> sectors;
   Sectors& getSectorsDontCreate(const MovementType&) const;
@@ -205,7 +226,7 @@ class Level : public OwnedObject<Level> {
   struct Private {};
 
   static PLevel create(SquareArray s, FurnitureArray f, Model* m, Table<double> sun, LevelId id,
-      Table<bool> cover, Table<bool> unavailable, const ContentFactory*);
+      Table<bool> cover, Table<bool> unavailable, TileGas, const ContentFactory*);
 
   public:
   Level(Private, SquareArray, FurnitureArray, Model*, Table<double> sunlight, LevelId);
@@ -13,6 +13,7 @@
 #include "movement_set.h"
 #include "content_factory.h"
 #include "creature_name.h"
+#include "tile_gas.h"
 
 LevelBuilder::LevelBuilder(ProgressMeter* meter, RandomGen& r, ContentFactory* contentFactory, int width, int height,
     bool allCovered, optional<double> defaultLight)
@@ -36,6 +37,10 @@ RandomGen& LevelBuilder::getRandom() {
   return random;
 }
 
+ScratchBuffer& LevelBuilder::getScratch() {
+  return scratch;
+}
+
 ContentFactory* LevelBuilder::getContentFactory() const {
   return contentFactory;
 }
@@ -186,12 +191,17 @@ PLevel LevelBuilder::build(const ContentFactory* factory, Model* m, LevelMaker*
   CHECK(!!m);
   CHECK(mapStack.empty());
   maker->make(this, squares.getBounds());
+  scratch.reset();
   for (Vec2 v : squares.getBounds())
     if (!items[v].empty())
       squares.getWritable(v)->dropItemsLevelGen(std::move(items[v]));
+  TileGas gas(squares.getBounds());
   for (auto& elem : permanentGas)
-    squares.getWritable(elem.second)->addPermanentGas(elem.first, 1);
-  auto l = Level::create(std::move(squares), std::move(furniture), m, sunlight, levelId, covered, unavailable, factory);
+    gas.addPermanentAmount(elem.second, elem.first, 1);
+  if (!m->getLevels().empty())
+    furniture.sharePrototypes(*m->getLevels()[0]->furniture);
+  auto l = Level::create(std::move(squares), std::move(furniture), m, sunlight, levelId, covered, unavailable,
+      std::move(gas), factory);
   for (pair<PCreature, Vec2>& c : creatures) {
     Position pos(c.second, l.get());
     /*CHECK(pos.canEnter(c.first.get())) << c.first->getName().bare();
@@ -8,6 +8,7 @@
 #include "square_attrib.h"
 #include "tile_gas_type.h"
 #include "creature_list.h"
+#include "scratch_buffer.h"
 
 class ProgressMeter;
 class Model;
@@ -107,6 +108,9 @@ class LevelBuilder {
   RandomGen& getRandom();
   ContentFactory* getContentFactory() const;
 
+  /** Memory for temporaries of level makers. It's released once the level is built.*/
+  ScratchBuffer& getScratch();
+
   CreatureList wildlife;
 
   private:
@@ -129,4 +133,5 @@ class LevelBuilder {
   ContentFactory* contentFactory;
   vector<pair<TileGasType, Vec2>> permanentGas;
   Table<int> mountainLevel;
+  ScratchBuffer scratch;
 };
@@ -53,6 +53,7 @@
 #include "collective_name.h"
 #include "position.h"
 #include "keeper_base_info.h"
+#include "scratch_buffer.h"
 
 namespace {
 
@@ -303,7 +304,7 @@ class RoomMaker : public LevelMaker {
 
   virtual void make(LevelBuilder* builder, Rectangle area) override {
     int spaceBetween = 0;
-    Table<int> taken(area.right(), area.bottom());
+    auto taken = builder->getScratch().getTable(Rectangle(area.right(), area.bottom()), 0);
     for (Vec2 v : area)
       taken[v] = onType && !builder->isFurnitureType(v, *onType);
     for (int i : Range(numRooms)) {
@@ -434,7 +435,7 @@ class Connector : public LevelMaker {
         return 1.;
       else
         return ShortestPath::infinity;};
-    Table<bool> connected(area, false);
+    auto connected = builder->getScratch().getTable(area, false);
     while (1) {
       Dijkstra dijkstra(area, {p1}, 10000, dijkstraFun);
       for (Vec2 v : area)
@@ -803,7 +804,7 @@ class Blob : public LevelMaker {
 
   virtual void make(LevelBuilder* builder, Rectangle area) override {
     vector<Vec2> squares;
-    Table<char> isInside(area, 0);
+    auto isInside = builder->getScratch().getTable<char>(area, 0);
     Vec2 center = area.middle();
     squares.push_back(center);
     isInside[center] = 1;
@@ -811,7 +812,7 @@ class Blob : public LevelMaker {
       vector<Vec2> nextPos;
       for (auto pos : squares)
         for (Vec2 next : pos.neighbors4())
-          if (next.inRectangle(area) && !squares.contains(next))
+          if (next.inRectangle(area) && !isInside[next])
             nextPos.push_back(next);
       vector<double> probs = nextPos.transform([&](Vec2 v) {
           double px = std::abs(v.x - center.x);
@@ -828,7 +829,7 @@ class Blob : public LevelMaker {
     }
     queue<Vec2> q;
     int inf = 10000;
-    Table<int> distance(area, inf);
+    auto distance = builder->getScratch().getTable(area, inf);
     for (Vec2 v : isInside.getBounds())
       if (!isInside[v]) {
         distance[v] = 0;
@@ -945,11 +946,9 @@ class Buildings : public LevelMaker {
         insideMaker ? makeVec<PLevelMaker>(std::move(insideMaker)) : vector<PLevelMaker>(), roadConnection) {}
 
   virtual void make(LevelBuilder* builder, Rectangle area) override {
-    Table<bool> filled(area);
+    auto filled = builder->getScratch().getTable(area, false);
     int width = area.width();
     int height = area.height();
-    for (Vec2 v : area)
-      filled[v] =  0;
     int spaceBetween = 1;
     int alignHeight = 0;
     if (align) {
@@ -983,7 +982,7 @@ class Buildings : public LevelMaker {
         }
         Vec2 tmp(px - spaceBetween, py - spaceBetween);
         for (Vec2 v : Rectangle(w + spaceBetween * 2 + 1, h + spaceBetween * 2 + 1))
-          if (!(tmp + v).inRectangle(area) || filled[px + v.x - spaceBetween][py + v.y - spaceBetween]) {
+          if (!(tmp + v).inRectangle(area) || filled[Vec2(px + v.x - spaceBetween, py + v.y - spaceBetween)]) {
             spaceOk = false;
             break;
           }
@@ -1011,7 +1010,7 @@ class Buildings : public LevelMaker {
             // if the building is large enough, don't place door near the corner
           Vec2(px + (w >= 4 ? builder->getRandom().get(2, w - 1) : builder->getRandom().get(1, w)),
                py + (buildingRow * h)) :
-          getRandomExit(Random, Rectangle(px, py, px + w + 1, py + h + 1), (w >= 4 && h >= 4) ? 2 : 1);
+          getRandomExit(builder->getRandom(), Rectangle(px, py, px + w + 1, py + h + 1), (w >= 4 && h >= 4) ? 2 : 1);
       if (building.floorInside)
         builder->resetFurniture(doorLoc, *building.floorInside);
       if (building.door)
@@ -1358,12 +1357,12 @@ class Margin : public LevelMaker {
   PLevelMaker inside;
 };
 
-void raiseLocalMinima(Table<double>& t) {
+void raiseLocalMinima(Table<double>& t, ScratchBuffer& scratch) {
   Vec2 minPos = t.getBounds().topLeft();
   for (Vec2 v : t.getBounds())
     if (t[v] < t[minPos])
       minPos = v;
-  Table<bool> visited(t.getBounds(), false);
+  auto visited = scratch.getTable(t.getBounds(), false);
   auto comparator = [&](const Vec2& v1, const Vec2& v2) { return t[v1] > t[v2];};
   priority_queue<Vec2, vector<Vec2>, decltype(comparator)> q(comparator);
   q.push(minPos);
@@ -1381,15 +1380,6 @@ void raiseLocalMinima(Table<double>& t) {
   }
 }
 
-vector<double> sortedValues(const Table<double>& t) {
-  vector<double> values;
-  for (Vec2 v : t.getBounds()) {
-    values.push_back(t[v]);
-  }
-  std::sort(values.begin(), values.end());
-  return values;
-}
-
 class SetSunlight : public LevelMaker {
   public:
   SetSunlight(double a, Predicate p) : amount(a), pred(p) {}
@@ -1405,9 +1395,9 @@ class SetSunlight : public LevelMaker {
   Predicate pred;
 };
 
-static void removeEdge(Table<bool>& values, int thickness) {
+static void removeEdge(ScratchTable<bool>& values, int thickness, ScratchBuffer& scratch) {
   auto bounds = values.getBounds();
-  Table<int> distance(bounds, 1000000);
+  auto distance = scratch.getTable(bounds, 1000000);
   queue<Vec2> q;
   for (auto v : bounds)
     if (!values[v]) {
@@ -1438,19 +1428,25 @@ class Mountains : public LevelMaker {
 
   virtual void make(LevelBuilder* builder, Rectangle area) override {
     Table<double> wys = genNoiseMap(builder->getRandom(), area, noiseInit, varianceMult);
-    raiseLocalMinima(wys);
-    vector<double> values = sortedValues(wys);
-    double cutOffLowland = values[min(values.size() - 1, (int)(info.lowlandRatio * double(values.size() - 1)))];
-    int cutOffHillIndex = min(values.size() - 1, (int)((info.hillRatio + info.lowlandRatio) * double(values.size() - 1)));
-    double cutOffHill = values[cutOffHillIndex];
-    double cutOffDarkness = values[min(values.size() - 1, (int)((info.hillRatio + info.lowlandRatio + 1.0) * 0.5 * double(values.size() - 1)))];
+    raiseLocalMinima(wys, builder->getScratch());
+    const int numValues = area.area();
+    const int cutOffHillIndex = min(numValues - 1, (int)((info.hillRatio + info.lowlandRatio) * double(numValues - 1)));
     const int numMountainLevels = info.numMountainLevels;
-    vector<double> mountainLevelCutoffs;
+    vector<int> indices {
+      min(numValues - 1, (int)(info.lowlandRatio * double(numValues - 1))),
+      cutOffHillIndex,
+      min(numValues - 1, (int)((info.hillRatio + info.lowlandRatio + 1.0) * 0.5 * double(numValues - 1)))
+    };
     for (int i : Range(1, numMountainLevels + 1))
-      mountainLevelCutoffs.push_back(values[cutOffHillIndex * (numMountainLevels - i) / numMountainLevels 
-          + (values.size() - 1) * i / numMountainLevels]);
+      indices.push_back(cutOffHillIndex * (numMountainLevels - i) / numMountainLevels
+          + (numValues - 1) * i / numMountainLevels);
+    auto values = getSortedValues(wys, indices);
+    double cutOffLowland = values[0];
+    double cutOffHill = values[1];
+    double cutOffDarkness = values[2];
+    vector<double> mountainLevelCutoffs = values.getSubsequence(3);
     int dCnt = 0, mCnt = 0, hCnt = 0, lCnt = 0;
-    Table<bool> isMountain(area, false);
+    auto isMountain = builder->getScratch().getTable(area, false);
     for (Vec2 v : area) {
       builder->setHeightMap(v, wys[v]);
       if (wys[v] >= cutOffHill) {
@@ -1476,7 +1472,7 @@ class Mountains : public LevelMaker {
       }
     }
     // Remove the MOUNTAIN2 tiles that are too close to the edge of the mountain
-    removeEdge(isMountain, 20);
+    removeEdge(isMountain, 20, builder->getScratch());
     for (auto v : area)
       if (isMountain[v])
         builder->putFurniture(v, {info.mountainDeep, tribe}, SquareAttrib::MOUNTAIN);
@@ -1588,8 +1584,7 @@ class Forrest : public LevelMaker {
   virtual void make(LevelBuilder* builder, Rectangle area) override {
     auto furnitureList = builder->getContentFactory()->furniture.getFurnitureList(info.trees);
     Table<double> wys = genNoiseMap(builder->getRandom(), area, {0, 0, 0, 0, 0}, 0.65);
-    vector<double> values = sortedValues(wys);
-    double cutoff = values[min(values.size() - 1, int(values.size() * info.ratio))];
+    double cutoff = getSortedValues(wys, {min(area.area() - 1, int(area.area() * info.ratio))})[0];
     auto pred = Predicate::type(info.onType);
     for (Vec2 v : area)
       if (pred.apply(builder, v) && builder->canNavigate(v, {MovementTrait::WALK}) && wys[v] < cutoff) {
@@ -2042,7 +2037,7 @@ static PMakerQueue village(RandomGen& random, SettlementInfo info, int minRooms,
   return queue;
 }
 
-static PMakerQueue cottage(SettlementInfo info, const BuildingInfo& building, int difficulty) {
+static PMakerQueue cottage(RandomGen& random, SettlementInfo info, const BuildingInfo& building, int difficulty) {
   auto queue = make_unique<MakerQueue>();
   if (building.floorOutside)
     queue->addMaker(make_unique<Empty>(*building.floorOutside));
@@ -2050,7 +2045,7 @@ static PMakerQueue cottage(SettlementInfo info, const BuildingInfo& building, in
   if (info.furniture)
     room->addMaker(make_unique<Furnitures>(Predicate::attrib(SquareAttrib::ROOM), 0.3, *info.furniture, info.tribe));
   if (!info.shopItems.empty())
-    room->addMaker(make_unique<ShopMaker>(Random.choose(info.shopItems), info, difficulty));
+    room->addMaker(make_unique<ShopMaker>(random.choose(info.shopItems), info, difficulty));
   if (building.prettyFloor)
     room->addMaker(make_unique<Empty>(SquareChange(*building.prettyFloor)));
   queue->addMaker(make_unique<Buildings>(1, 2, 5, 7, building, info.tribe, false, std::move(room), false));
@@ -2163,7 +2158,7 @@ PLevelMaker LevelMaker::blackMarket(RandomGen& random, SettlementInfo info, Vec2
         make_unique<BorderGuard>(
             make_unique<ShopMaker>(items, info, difficulty),
             SquareChange(building.wall)),
-        Vec2(Random.get(5, 8), Random.get(5, 8)),
+        Vec2(random.get(5, 8), random.get(5, 8)),
         Predicate::alwaysTrue());
   marketArea->addMaker(make_unique<BorderGuard>(std::move(locations), SquareChange(building.wall)));
   if (info.collective)
@@ -2831,7 +2826,7 @@ static PMakerQueue getSettlementMaker(const ContentFactory& contentFactory, Rand
           case BuiltinLayoutId::CASTLE2:
             return castle2(random, settlement, type.buildingInfo, difficulty);
           case BuiltinLayoutId::COTTAGE:
-            return cottage(settlement, type.buildingInfo, difficulty);
+            return cottage(random, settlement, type.buildingInfo, difficulty);
           case BuiltinLayoutId::FORREST_COTTAGE:
             return forrestCottage(settlement, type.buildingInfo, difficulty);
           case BuiltinLayoutId::TOWER:
@@ -3085,7 +3080,7 @@ PLevelMaker LevelMaker::getWaterZLevel(RandomGen& random, FurnitureType waterTyp
   queue->addMaker(make_unique<Empty>(SquareChange(waterType)));
   auto locations = make_unique<RandomLocations>();
   for (int i : Range(5))
-    locations->add(make_unique<UniformBlob>(SquareChange(FurnitureType("FLOOR"))), Vec2(Random.get(5, 10), Random.get(5, 10)),
+    locations->add(make_unique<UniformBlob>(SquareChange(FurnitureType("FLOOR"))), Vec2(random.get(5, 10), random.get(5, 10)),
         RandomLocations::LocationPredicate(Predicate::alwaysTrue()));
   queue->addMaker(std::move(locations));
   queue->addMaker(make_unique<Creatures>(std::move(enemies), TribeId::getMonster(), MonsterAIFactory::monster()));
@@ -3261,7 +3256,7 @@ class UpLevelMaker : public LevelMaker {
   UpLevelMaker(Position p, const BiomeInfo& biome) : origin(p), biome(biome) {}
 
   virtual void make(LevelBuilder* builder, Rectangle area) override {
-    Table<bool> isMountain2(area, false);
+    auto isMountain2 = builder->getScratch().getTable(area, false);
     int thisHeight = 1;
     auto level =  origin.getLevel();
     auto ground = level;
@@ -3284,7 +3279,7 @@ class UpLevelMaker : public LevelMaker {
         builder->setSunlight(v, ground->getLevelGenSunlight(v));
         isMountain2[v] = true;
       }
-    removeEdge(isMountain2, 20);
+    removeEdge(isMountain2, 20, builder->getScratch());
     for (auto v : area)
       if (isMountain2[v]) {
         builder->putFurniture(v, biome.mountains.mountainDeep, TribeId::getMonster());
@@ -3297,7 +3292,7 @@ class UpLevelMaker : public LevelMaker {
 };
 }
 
-PLevelMaker LevelMaker::upLevel(Position pos, const BiomeInfo& biomeInfo, vector<SettlementInfo> settlements,
+PLevelMaker LevelMaker::upLevel(RandomGen& random, Position pos, const BiomeInfo& biomeInfo, vector<SettlementInfo> settlements,
     optional<ResourceCounts> resources) {
   auto queue = make_unique<MakerQueue>();
   queue->addMaker(make_unique<UpLevelMaker>(pos, biomeInfo));
@@ -3306,18 +3301,18 @@ PLevelMaker LevelMaker::upLevel(Position pos, const BiomeInfo& biomeInfo, vector
   for (auto& settlement : settlements) {
     auto locations = make_unique<RandomLocations>();
     locations->add(make_unique<MakerQueue>(
-            getSettlementMaker(factory, Random, settlement, 0),
+            getSettlementMaker(factory, random, settlement, 0),
             make_unique<Connector>(none, TribeId::getMonster(), 5,
                 Predicate::canEnter({MovementTrait::WALK}),
                 SquareAttrib::CONNECTOR)
         ),
-        getSize(factory.mapLayouts, Random, settlement.type),
+        getSize(factory.mapLayouts, random, settlement.type),
         getSettlementPredicate(settlement.type));
     queue->addMaker(std::move(locations));
   }
   if (resources) {
     auto resLocations = make_unique<RandomLocations>();
-    generateResources(Random, *resources, nullptr, resLocations.get(), {}, 0, TribeId::getMonster());
+    generateResources(random, *resources, nullptr, resLocations.get(), {}, 0, TribeId::getMonster());
     queue->addMaker(std::move(resLocations));
   }
   auto all = make_unique<MakerQueue>();
@@ -0,0 +1,122 @@
+#include "stdafx.h"
+#include "light_map.h"
+#include "level.h"
+#include "field_of_view.h"
+
+SERIALIZE_DEF(LightMap, level, lightAmount, lightCapAmount, sources, maxRadius)
+
+SERIALIZATION_CONSTRUCTOR_IMPL(LightMap)
+
+LightMap::LightMap(Level* l, Rectangle bounds) : level(l), lightAmount(bounds, 0), lightCapAmount(bounds, 1) {
+}
+
+int LightMap::Stencil::getIndex(Vec2 offset) const {
+  if (offset.x < -size || offset.y < -size || offset.x > size || offset.y > size)
+    return -1;
+  return index[(offset.x + size) * (2 * size + 1) + offset.y + size];
+}
+
+const LightMap::Stencil& LightMap::getStencil(double radius) {
+  static map<double, unique_ptr<Stencil>> stencils;
+  static std::mutex stencilMutex;
+  std::unique_lock<std::mutex> lock(stencilMutex);
+  auto& ret = stencils[radius];
+  if (!ret) {
+    ret = make_unique<Stencil>();
+    ret->size = int(radius);
+    ret->index = vector<int>((2 * ret->size + 1) * (2 * ret->size + 1), -1);
+    for (Vec2 v : Rectangle::centered(ret->size)) {
+      double dist = v.lengthD();
+      if (dist <= radius) {
+        ret->index[(v.x + ret->size) * (2 * ret->size + 1) + v.y + ret->size] = ret->offsets.size();
+        ret->offsets.push_back(v);
+        ret->weights.push_back(min(1.0, 1 - dist / radius));
+      }
+    }
+  }
+  return *ret;
+}
+
+void LightMap::computeTiles(Vec2 pos, Source& source, FieldOfView& fov) const {
+  auto& stencil = getStencil(source.radius);
+  source.tiles.clear();
+  for (int i : All(stencil.offsets)) {
+    auto v = pos + stencil.offsets[i];
+    if (v.inRectangle(lightAmount.getBounds()) && fov.canSee(pos, v))
+      source.tiles.push_back(i);
+  }
+}
+
+void LightMap::apply(Vec2 pos, const Source& source, int num) {
+  auto& stencil = getStencil(source.radius);
+  auto& table = source.darkness ? lightCapAmount : lightAmount;
+  const double sign = source.darkness ? -1 : 1;
+  for (int i : source.tiles) {
+    auto v = pos + stencil.offsets[i];
+    table[v] += sign * stencil.weights[i] * num;
+    level->setNeedsRenderUpdate(v, true);
+  }
+}
+
+void LightMap::addSource(Vec2 pos, double radius, bool darkness, int num, FieldOfView& fov) {
+  PROFILE;
+  if (radius <= 0)
+    return;
+  auto& list = sources[pos];
+  for (int i : All(list))
+    if (list[i].radius == radius && list[i].darkness == darkness) {
+      apply(pos, list[i], num);
+      list[i].count += num;
+      if (list[i].count == 0) {
+        list.removeIndex(i);
+        if (list.empty())
+          sources.erase(pos);
+      }
+      return;
+    }
+  list.push_back(Source{radius, darkness, num, {}});
+  computeTiles(pos, list.back(), fov);
+  apply(pos, list.back(), num);
+  maxRadius = max(maxRadius, int(radius));
+}
+
+void LightMap::addLightSource(Vec2 pos, double radius, int num, FieldOfView& fov) {
+  addSource(pos, radius, false, num, fov);
+}
+
+void LightMap::addDarknessSource(Vec2 pos, double radius, int num, FieldOfView& fov) {
+  addSource(pos, radius, true, num, fov);
+}
+
+double LightMap::getLightAmount(Vec2 pos) const {
+  return lightAmount[pos];
+}
+
+double LightMap::getLightCapAmount(Vec2 pos) const {
+  return lightCapAmount[pos];
+}
+
+vector<LightMap::SourceId> LightMap::detachSources(Vec2 changed) {
+  PROFILE;
+  vector<SourceId> ret;
+  for (Vec2 pos : Rectangle::centered(changed, maxRadius).intersection(lightAmount.getBounds()))
+    if (auto list = getReferenceMaybe(sources, pos))
+      for (int i : All(*list)) {
+        auto& source = (*list)[i];
+        auto index = getStencil(source.radius).getIndex(changed - pos);
+        if (index > -1 && std::binary_search(source.tiles.begin(), source.tiles.end(), index)) {
+          apply(pos, source, -source.count);
+          ret.push_back(make_pair(pos, i));
+        }
+      }
+  return ret;
+}
+
+void LightMap::attachSources(const vector<SourceId>& ids, FieldOfView& fov) {
+  PROFILE;
+  for (auto& id : ids) {
+    auto& source = sources.at(id.first)[id.second];
+    computeTiles(id.first, source, fov);
+    apply(id.first, source, source.count);
+  }
+}
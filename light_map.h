@@ -0,0 +1,52 @@
+#pragma once
+
+#include "util.h"
+
+class Level;
+class FieldOfView;
+
+/** Accumulates light and darkness from all sources on a level. Every source remembers which tiles of its
+    precomputed falloff stencil it has lit, so removing it doesn't need another field of view query, and
+    a changed tile only requires recomputing the sources that could see it.*/
+class LightMap {
+  public:
+  LightMap(Level*, Rectangle bounds);
+  void addLightSource(Vec2, double radius, int num, FieldOfView&);
+  void addDarknessSource(Vec2, double radius, int num, FieldOfView&);
+  double getLightAmount(Vec2) const;
+  double getLightCapAmount(Vec2) const;
+
+  using SourceId = pair<Vec2, int>;
+  /** Removes the contribution of all sources that can see the given tile and returns them, so they can be
+      reapplied with attachSources() once the field of view is updated.*/
+  vector<SourceId> detachSources(Vec2);
+  void attachSources(const vector<SourceId>&, FieldOfView&);
+
+  SERIALIZATION_DECL(LightMap)
+
+  private:
+  struct Stencil {
+    vector<Vec2> offsets;
+    vector<double> weights;
+    int size;
+    vector<int> index;
+    int getIndex(Vec2 offset) const;
+  };
+  static const Stencil& getStencil(double radius);
+
+  struct Source {
+    double SERIAL(radius);
+    bool SERIAL(darkness);
+    int SERIAL(count);
+    vector<int> SERIAL(tiles);
+    SERIALIZE_ALL(radius, darkness, count, tiles)
+  };
+  void addSource(Vec2, double radius, bool darkness, int num, FieldOfView&);
+  void computeTiles(Vec2, Source&, FieldOfView&) const;
+  void apply(Vec2, const Source&, int num);
+  Level* SERIAL(level) = nullptr;
+  Table<double> SERIAL(lightAmount);
+  Table<double> SERIAL(lightCapAmount);
+  HashMap<Vec2, vector<Source>> SERIAL(sources);
+  int SERIAL(maxRadius) = 0;
+};
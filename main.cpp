@@ -58,6 +58,10 @@
 #include "unlocks.h"
 #include "steam_input.h"
 #include "steam_achievements.h"
+#include "melee_batch.h"
+#include "creature.h"
+#include "item.h"
+#include "slab_allocator.h"
 
 #include "stack_printer.h"
 
@@ -135,8 +139,11 @@ static po::parser getCommandLineFlags() {
   flags["endless_enemy"].type(po::string).description("Endless mode enemy index");
   flags["battle_view"].description("Open game window and display battle");
   flags["battle_rounds"].type(po::i32).description("Number of battle rounds");
+  flags["batched_combat"].description("Resolve all hits of a melee attack together");
   flags["layout_size"].type(po::string).description("Size of the generated map layout");
   flags["layout_name"].type(po::string).description("Name of layout to generate");
+  flags["layout_benchmark"].type(po::i32).description("Time layout generation over a number of runs instead of printing a layout");
+  flags["alloc_benchmark"].type(po::i32).description("Time pooled allocation of creatures and items for a number of objects");
   flags["stderr"].description("Log to stderr");
   flags["nolog"].description("No logging");
   flags["no_crash_reports"].description("Don't intercept game crashes and send crash reports to the developer");
@@ -296,6 +303,7 @@ static int keeperMain(po::parser& commandLineFlags) {
   if (commandLineFlags["max_turns"].was_set())
     maxTurns = commandLineFlags["max_turns"].get().i32;
   Clock clock(!!maxTurns);
+  MeleeBatch::setEnabled(commandLineFlags["batched_combat"].was_set());
   userPath.createIfDoesntExist();
   auto settingsPath = userPath.file("options_v1_0.txt");
   auto userKeysPath = userPath.file("keybindings.txt");
@@ -333,6 +341,7 @@ static int keeperMain(po::parser& commandLineFlags) {
   if (options.getBoolValue(OptionId::DPI_AWARE))
     dpiAwareness();
   Random.init(int(time(nullptr)));
+  IdRandom.init(int(time(nullptr)));
   auto installId = getInstallId(userPath.file("installId.txt"), Random);
   if (steamInput->isRunningOnDeck())
     installId += "_deck";
@@ -346,15 +355,28 @@ static int keeperMain(po::parser& commandLineFlags) {
     loop.genZLevels(commandLineFlags["gen_z_levels"].get().string);
     exit(0);
   }
+  if (commandLineFlags["alloc_benchmark"].was_set()) {
+    auto numObjects = commandLineFlags["alloc_benchmark"].get().i32;
+    benchmarkSlabAllocator("Creature", sizeof(Creature), numObjects);
+    benchmarkSlabAllocator("Item", sizeof(Item), numObjects);
+    exit(0);
+  }
   if (commandLineFlags["layout_name"].was_set()) {
     USER_CHECK(commandLineFlags["layout_size"].was_set()) << "Need to specify layout_size option";
     MainLoop loop(nullptr, nullptr, nullptr, paidDataPath, freeDataPath, userPath, modsDir, &options, nullptr, nullptr, nullptr,
         &allUnlocked, nullptr, 0, "");
-    generateMapLayout(loop,
-        commandLineFlags["layout_name"].get().string,
-        freeDataPath.file("glyphs.txt"),
-        commandLineFlags["layout_size"].get().string
-    );
+    if (commandLineFlags["layout_benchmark"].was_set())
+      benchmarkMapLayouts(loop,
+          commandLineFlags["layout_name"].get().string,
+          commandLineFlags["layout_size"].get().string,
+          commandLineFlags["layout_benchmark"].get().i32
+      );
+    else
+      generateMapLayout(loop,
+          commandLineFlags["layout_name"].get().string,
+          freeDataPath.file("glyphs.txt"),
+          commandLineFlags["layout_size"].get().string
+      );
     exit(0);
   }
   SokobanInput sokobanInput(freeDataPath.file("sokoban_input.txt"), userPath.file("sokoban_state.txt"));
@@ -435,7 +457,8 @@ static int keeperMain(po::parser& commandLineFlags) {
   showLogoSplash(renderer, freeDataPath.file("images/succubi.png"), splashDone);
   loadThread.join();
   GuiFactory guiFactory(renderer, &clock, &options, soundLibrary, freeDataPath.subdirectory("images"));
-  TileSet tileSet(paidDataPath.subdirectory("images"), modsDir, freeDataPath.subdirectory("ui"));
+  TileSet tileSet(paidDataPath.subdirectory("images"), modsDir, freeDataPath.subdirectory("ui"),
+      userPath.subdirectory("sprite_cache"));
   renderer.setTileSet(&tileSet);
   unique_ptr<fx::FXManager> fxManager;
   unique_ptr<fx::FXRenderer> fxRenderer;
@@ -48,6 +48,7 @@
 #include "enemy_info.h"
 #include "level.h"
 #include "simple_game.h"
+#include "move_cache.h"
 #include "monster_ai.h"
 #include "mem_usage_counter.h"
 #include "gui_elem.h"
@@ -1171,6 +1172,7 @@ void MainLoop::endlessTest(int numTries, const FilePath& levelPath, const FilePa
 
 int MainLoop::battleTest(int numTries, const FilePath& levelPath, vector<CreatureList> ally, vector<CreatureList> enemies) {
   ProgressMeter meter(1);
+  resetMoveCacheStats();
   int numAllies = 0;
   int numEnemies = 0;
   int numUnknown = 0;
@@ -1228,6 +1230,7 @@ int MainLoop::battleTest(int numTries, const FilePath& levelPath, vector<Creatur
   if (numUnknown > 0)
     std::cerr << " (" << numUnknown << ") unknown";
   std::cerr << "\n";
+  std::cerr << getMoveCacheReport();
   return numAllies;
 }
 
@@ -70,7 +70,7 @@ bool MapMemory::containsLevel(Level* l) const {
   return table->containsLevel(l);
 }
 
-const HashSet<Position>& MapMemory::getUpdated(const Level* level) const {
+const PositionSet& MapMemory::getUpdated(const Level* level) const {
   return updated[level->getUniqueId()];
 }
 
@@ -28,7 +28,7 @@ class MapMemory {
   MapMemory();
   void addObject(Position, const ViewObject&);
   void update(Position, const ViewIndex&);
-  const HashSet<Position>& getUpdated(const Level*) const;
+  const PositionSet& getUpdated(const Level*) const;
   void clearUpdated(const Level*) const;
   void clearSquare(Position pos);
   static const MapMemory& empty();
@@ -0,0 +1,131 @@
+#include "stdafx.h"
+#include "melee_batch.h"
+#include "creature.h"
+#include "creature_attributes.h"
+#include "equipment.h"
+#include "item.h"
+#include "game.h"
+#include "content_factory.h"
+
+double getMeleeDamage(double damageRatio) {
+  constexpr double minRatio = 0.3;  // the ratio at which the damage drops to 0
+  constexpr double maxRatio = 2.2;     // the ratio at which the damage reaches 1
+  constexpr double damageAtOne = 0.12;// damage dealt at a ratio of 1
+  if (damageRatio <= minRatio)
+    return 0;
+  else if (damageRatio <= 1)
+    return damageAtOne * (damageRatio - minRatio) / (1.0 - minRatio);
+  else if (damageRatio <= maxRatio)
+    return damageAtOne + (1.0 - damageAtOne) * (damageRatio - 1.0) / (maxRatio - 1.0);
+  else
+    return 1.0;
+}
+
+static bool batchingEnabled = false;
+
+void MeleeBatch::setEnabled(bool value) {
+  batchingEnabled = value;
+}
+
+bool MeleeBatch::isEnabled() {
+  return batchingEnabled;
+}
+
+bool MeleeBatch::Key::operator == (const Key& o) const {
+  return attributesGeneration == o.attributesGeneration && attributesVersion == o.attributesVersion &&
+      equipmentVersion == o.equipmentVersion && buffsVersion == o.buffsVersion &&
+      combatExperience == o.combatExperience && captureOrdered == o.captureOrdered && tribe == o.tribe &&
+      position == o.position;
+}
+
+bool MeleeBatch::Key::operator != (const Key& o) const {
+  return !(*this == o);
+}
+
+MeleeBatch::Key MeleeBatch::getKey(const Creature* c) {
+  return Key{c->getAttributesGeneration(), c->getAttributes().getVersion(), c->getEquipment().getVersion(),
+      c->getBuffsVersion(), c->getCombatExperience(true, true), c->isCaptureOrdered(), c->getTribeId(),
+      c->getPosition()};
+}
+
+MeleeBatch::MeleeBatch(const Creature* attacker, const Creature* victim, const vector<pair<Item*, double>>& weapons)
+    : attacker(attacker), victim(victim), weapons(weapons), strength(weapons.size()),
+      damageAttr(weapons.transform([](auto& w) { return w.first->getWeaponInfo().meleeAttackAttr; })),
+      defenseIndex(weapons.size()), damage(weapons.size()) {
+}
+
+void MeleeBatch::gatherAttacker(int from) {
+  auto factory = attacker->getGame()->getContentFactory();
+  attackerSpecial = false;
+  for (int i = from; i < weapons.size(); ++i) {
+    auto attr = weapons[i].first->getWeaponInfo().meleeAttackAttr;
+    attackerSpecial |= attacker->hasSpecialAttr(attr);
+    strength[i] = attacker->getMeleeStrength(weapons[i], victim);
+    damageAttr[i] = attacker->modifyDamageAttr(attr, factory);
+  }
+  attackerKey = getKey(attacker);
+  victimKey = none;
+}
+
+void MeleeBatch::resolve(const vector<int>& strength, const vector<int>& defenseIndex, const vector<double>& defense,
+    vector<double>& damage, int from) {
+  for (int i = from; i < strength.size(); ++i)
+    damage[i] = getMeleeDamage((double) strength[i] / defense[defenseIndex[i]]);
+}
+
+void MeleeBatch::gatherVictim(int from, int baseDefense) {
+  victimSpecial = victim->hasSpecialAttr(AttrType("DEFENSE"));
+  defenseAttr.clear();
+  defense.clear();
+  for (int i = from; i < weapons.size(); ++i) {
+    if (auto index = defenseAttr.findElement(damageAttr[i]))
+      defenseIndex[i] = *index;
+    else {
+      defenseIndex[i] = defenseAttr.size();
+      defenseAttr.push_back(damageAttr[i]);
+      defense.push_back(victim->getMeleeDefense(baseDefense, damageAttr[i]));
+    }
+  }
+  resolve(strength, defenseIndex, defense, damage, from);
+  gatheredDefense = baseDefense;
+  victimKey = getKey(victim);
+}
+
+int MeleeBatch::getStrength(int hit) {
+  if (!attackerKey || *attackerKey != getKey(attacker))
+    gatherAttacker(hit);
+  if (attackerSpecial)
+    return attacker->getMeleeStrength(weapons[hit], victim);
+#ifdef CHECK_BATCHED_COMBAT
+  CHECK(strength[hit] == attacker->getMeleeStrength(weapons[hit], victim)) << "Stale strength of " << attacker->identify();
+#endif
+  return strength[hit];
+}
+
+AttrType MeleeBatch::getDamageAttr(int hit) {
+  if (!attackerKey || *attackerKey != getKey(attacker))
+    gatherAttacker(hit);
+  return damageAttr[hit];
+}
+
+double MeleeBatch::getDamage(int hit, int baseDefense) {
+  auto strength = getStrength(hit);
+  if (!victimKey || *victimKey != getKey(victim) || gatheredDefense != baseDefense)
+    gatherVictim(hit, baseDefense);
+  auto computeDamage = [&] {
+    double defense = baseDefense;
+    defense += victim->getSpecialAttr(AttrType("DEFENSE"), attacker);
+    return getMeleeDamage((double) strength / victim->getMeleeDefense(defense, damageAttr[hit]));
+  };
+  if (attackerSpecial || victimSpecial)
+    return computeDamage();
+#ifdef CHECK_BATCHED_COMBAT
+  CHECK(damage[hit] == computeDamage()) << "Stale damage against " << victim->identify();
+#endif
+  return damage[hit];
+}
+
+void MeleeBatch::invalidate() {
+  attackerKey = none;
+  victimKey = none;
+}
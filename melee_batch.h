@@ -0,0 +1,66 @@
+#pragma once
+
+#include "util.h"
+#include "attr_type.h"
+#include "position.h"
+#include "tribe.h"
+
+class Creature;
+class Item;
+
+// The fraction of the victim's health taken by a hit with the given strength to defense ratio.
+double getMeleeDamage(double damageRatio);
+
+/** Resolves all hits of a single melee attack action together. The attacker's strength and the victim's defense
+    are gathered once into parallel arrays and the damage of all queued hits is computed in one pass. The hits are still
+    applied one by one, in order and with the same random rolls as the sequential path. Any change that may affect
+    the gathered stats makes the remaining hits gather again, so the results are identical to the sequential path.*/
+class MeleeBatch {
+  public:
+  static void setEnabled(bool);
+  static bool isEnabled();
+
+  MeleeBatch(const Creature* attacker, const Creature* victim, const vector<pair<Item*, double>>& weapons);
+
+  int getStrength(int hit);
+  AttrType getDamageAttr(int hit);
+  // The victim's defense attribute is read by the caller before the attack wakes anyone up, as in the sequential path.
+  double getDamage(int hit, int baseDefense);
+  // Call after anything that the version counters don't cover, e.g. applying effects or capturing the victim.
+  void invalidate();
+
+  // The damage of hits [from, strength.size()), given the defense of each distinct damage type.
+  static void resolve(const vector<int>& strength, const vector<int>& defenseIndex, const vector<double>& defense,
+      vector<double>& damage, int from);
+
+  private:
+  struct Key {
+    int attributesGeneration;
+    int attributesVersion;
+    int equipmentVersion;
+    int buffsVersion;
+    double combatExperience;
+    bool captureOrdered;
+    TribeId tribe;
+    Position position;
+    bool operator == (const Key&) const;
+    bool operator != (const Key&) const;
+  };
+  static Key getKey(const Creature*);
+  void gatherAttacker(int from);
+  void gatherVictim(int from, int baseDefense);
+  const Creature* attacker;
+  const Creature* victim;
+  vector<pair<Item*, double>> weapons;
+  vector<int> strength;
+  vector<AttrType> damageAttr;
+  vector<int> defenseIndex;
+  vector<AttrType> defenseAttr;
+  vector<double> defense;
+  vector<double> damage;
+  optional<Key> attackerKey;
+  optional<Key> victimKey;
+  int gatheredDefense = 0;
+  bool attackerSpecial = false;
+  bool victimSpecial = false;
+};
@@ -37,7 +37,7 @@ static optional<Position> getTileToExplore(Collective* collective, const Creatur
   auto movementType = c->getMovementType();
   optional<Position> caveTile;
   optional<Position> outdoorTile;
-  for (auto& pos : Random.permutation(borderTiles)) {
+  for (auto& pos : Random.permutation(borderTiles.asVector())) {
     //CHECK(pos.getModel() == collective->getModel());
     if (pos.isCovered()) {
       if ((!caveTile || betterPos(c->getPosition(), *caveTile, pos)) &&
@@ -279,7 +279,7 @@ PTask MinionActivities::generate(Collective* collective, Creature* c, MinionActi
       auto& pigstyPos = collective->getConstructions().getBuiltPositions(FurnitureType("PIGSTY"));
       if (pigstyPos.count(c->getPosition()) && !myTerritory.empty()) {
         PROFILE_BLOCK("Leave pigsty");
-        return Task::doneWhen(Task::goTo(Random.choose(myTerritory)),
+        return Task::doneWhen(Task::goTo(Random.choose(myTerritory.asVector())),
             TaskPredicate::outsidePositions(c, pigstyPos));
       }
       auto& leaders = collective->getLeaders();
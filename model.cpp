@@ -95,6 +95,20 @@ int Model::getSaveProgressCount() const {
   return ret;
 }
 
+string Model::getMemoryReport() const {
+  string ret;
+  long long total = 0;
+  for (auto& l : levels) {
+    auto usage = l->getMemoryUsage();
+    total += usage.tiles;
+    ret += l->name + " " + toString(l->getBounds().getSize()) + ": " + toString(usage.tiles / 1024) + " KB, " +
+        toString(usage.numModifiedFurniture) + " modified furniture\n";
+  }
+  if (!levels.empty())
+    ret += "Shared furniture: " + toString(levels[0]->getMemoryUsage().sharedFurniture / 1024) + " KB\n";
+  return ret + "Total: " + toString(total / 1024) + " KB";
+}
+
 vector<Collective*> Model::getCollectives() const {
   return getWeakPointers(collectives);
 }
@@ -178,7 +192,7 @@ void Model::addCreature(PCreature c, TimeInterval delay) {
 
 Level* Model::buildLevel(const ContentFactory* factory, LevelBuilder b, PLevelMaker maker, int depth, string name) {
   LevelBuilder builder(std::move(b));
-  levels.push_back(builder.build(factory, this, maker.get(), Random.getLL()));
+  levels.push_back(builder.build(factory, this, maker.get(), IdRandom.getLL()));
   levels.back()->depth = depth;
   levels.back()->name = name;
   return levels.back().get();
@@ -208,7 +222,7 @@ Model::Model(Private) {
 PModel Model::create(ContentFactory* contentFactory, optional<MusicType> music, BiomeId biomeId) {
   auto ret = makeOwner<Model>(Private{});
   ret->cemetery = LevelBuilder(Random, contentFactory, 100, 100, false)
-      .build(contentFactory, ret.get(), LevelMaker::emptyLevel(FurnitureType("GRASS"), false).get(), Random.getLL());
+      .build(contentFactory, ret.get(), LevelMaker::emptyLevel(FurnitureType("GRASS"), false).get(), IdRandom.getLL());
   ret->eventGenerator = makeOwner<EventGenerator>();
   ret->defaultMusic = music;
   ret->biomeId = biomeId;
@@ -85,6 +85,7 @@ class Model : public OwnedObject<Model> {
   void addCollective(PCollective);
 
   int getSaveProgressCount() const;
+  string getMemoryReport() const;
 
   void killCreature(Creature* victim);
   void killCreature(PCreature victim);
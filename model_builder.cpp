@@ -41,12 +41,13 @@
 #include "zlevel.h"
 #include "avatar_info.h"
 #include "keeper_base_info.h"
+#include "scratch_buffer.h"
 
 using namespace std::chrono;
 
 ModelBuilder::ModelBuilder(ProgressMeter* m, RandomGen& r, Options* o,
     SokobanInput* sok, ContentFactory* contentFactory, EnemyFactory enemyFactory)
-    : random(r), meter(m), enemyFactory(std::move(enemyFactory)), sokobanInput(sok), contentFactory(contentFactory) {
+    : random(&r), meter(m), enemyFactory(std::move(enemyFactory)), sokobanInput(sok), contentFactory(contentFactory) {
 }
 
 ModelBuilder::~ModelBuilder() {
@@ -88,8 +89,8 @@ ModelBuilder::LevelMakerMethod ModelBuilder::getMaker(LevelType type) {
 
 void ModelBuilder::addMapVillains(vector<EnemyInfo>& enemyInfo, const vector<BiomeEnemyInfo>& info) {
   for (auto& enemy : info)
-    if (random.chance(enemy.probability))
-      for (int i : Range(random.get(enemy.count)))
+    if (random->chance(enemy.probability))
+      for (int i : Range(random->get(enemy.count)))
         enemyInfo.push_back(enemyFactory->get(enemy.id));
 }
 
@@ -102,7 +103,7 @@ PModel ModelBuilder::tryCampaignBaseModel(TribeAlignment alignment, optional<Kee
       : biomeInfo.whiteKeeperBaseEnemies);
   optional<ExternalEnemies> externalEnemies;
   if (externalEnemiesType)
-    externalEnemies = ExternalEnemies(random, &contentFactory->getCreatures(), enemyFactory->getExternalEnemies(),
+    externalEnemies = ExternalEnemies(*random, &contentFactory->getCreatures(), enemyFactory->getExternalEnemies(),
         *externalEnemiesType);
   return tryModel(114, 0, enemyInfo, getPlayerTribeId(alignment), std::move(keeperBase), biome, std::move(externalEnemies));
 }
@@ -131,17 +132,36 @@ PModel ModelBuilder::tryCampaignSiteModel(EnemyId enemyId, VillainType type, Tri
   return tryModel(type == VillainType::MINOR ? 60 : 114, difficulty, enemyInfo, none, none, biomeId, {});
 }
 
+void ModelBuilder::runSeeded(int seed, function<void()> fun) {
+  // Creature, item and name generation draw from the global generator, so the attempt's seed is swapped into it
+  // and the builder draws from it too. The global stream continues where it was once the attempt is done.
+  RandomGen attemptRandom;
+  attemptRandom.init(seed);
+  Random.swap(attemptRandom);
+  auto previous = random;
+  random = &Random;
+  OnExit restore([&] {
+    Random.swap(attemptRandom);
+    random = previous;
+  });
+  fun();
+}
+
 PModel ModelBuilder::tryBuilding(int numTries, function<PModel()> buildFun, const string& name) {
+  // Every attempt draws the layout from its own seed, so the seed of a failing attempt is logged.
+  int baseSeed = random->get(1000000000);
   for (int i : Range(numTries)) {
     try {
       if (meter)
         meter->reset();
-      return buildFun();
+      PModel ret;
+      runSeeded(baseSeed + i, [&] { ret = buildFun(); });
+      return ret;
     } catch (LevelGenException) {
-      INFO << "Retrying level gen";
+      INFO << "Retrying level gen, failed seed " << baseSeed + i;
     }
   }
-  USER_FATAL << "Couldn't generate a level: " << name;
+  USER_FATAL << "Couldn't generate a level: " << name << ", seeds " << baseSeed << " to " << baseSeed + numTries - 1;
   return nullptr;
 }
 
@@ -178,7 +198,7 @@ void ModelBuilder::measureSiteGen(int numTries, vector<string> types, vector<Bio
         for (auto biome : biomes)
           tasks.push_back([=] { measureModelGen(type + " (" + EnumInfo<TribeAlignment>::getString(alignment) + ", "
               + biome.data() + ")", numTries,
-              [&] { tryCampaignBaseModel(alignment, none, biome, none); }); });
+              [&] { return tryCampaignBaseModel(alignment, none, biome, none); }); });
     else if (type == "zlevels") {
 //      FATAL << "Fix after adding z level groups";
       for (auto alignment : ENUM_ALL(TribeAlignment))
@@ -189,37 +209,41 @@ void ModelBuilder::measureSiteGen(int numTries, vector<string> types, vector<Bio
               [&] {
                 auto model = tryCampaignBaseModel(alignment, none, BiomeId("GRASSLAND"), none);
                 auto size = model->getGroundLevel()->getBounds().getSize();
-                auto maker = getLevelMaker(Random, contentFactory, {"basic"}, i, TribeId::getDarkKeeper(), size,
+                auto maker = getLevelMaker(*random, contentFactory, {"basic"}, i, TribeId::getDarkKeeper(), size,
                     EnemyAggressionLevel(0));
-                LevelBuilder(Random, contentFactory, size.x, size.y, true)
+                LevelBuilder(*random, contentFactory, size.x, size.y, true)
                     .build(contentFactory, model.get(), maker.maker.get(), 123);
+                return model;
               }); });
     }
     else if (type == "tutorial")
-      tasks.push_back([=] { measureModelGen(type, numTries, [&] { tryTutorialModel(none); }); });
+      tasks.push_back([=] { measureModelGen(type, numTries, [&] { return tryTutorialModel(none); }); });
     else {
       auto id = EnemyId(type.data());
       for (auto alignment : ENUM_ALL(TribeAlignment))
         tasks.push_back([=] { measureModelGen(type, numTries, [&] {
-            tryCampaignSiteModel(id, VillainType::LESSER, alignment, Random.choose(biomes), 0); }); });
+            return tryCampaignSiteModel(id, VillainType::LESSER, alignment, random->choose(biomes), 0); }); });
     }
   }
   for (auto& t : tasks)
     t();
 }
 
-void ModelBuilder::measureModelGen(const string& name, int numTries, function<void()> genFun) {
+void ModelBuilder::measureModelGen(const string& name, int numTries, function<PModel()> genFun) {
   int numSuccess = 0;
   int maxT = 0;
   int minT = 1000000;
   double sumT = 0;
   USER_INFO << "Testing " << name;
+  int baseSeed = random->get(1000000000);
+  string memoryReport;
+  ScratchBuffer::resetStats();
   for (int i : Range(numTries)) {
 #ifndef OSX // this triggers some compiler errors OSX, I don't need it there anyway.
     auto time = steady_clock::now();
 #endif
     try {
-      genFun();
+      runSeeded(baseSeed + i, [&] { memoryReport = genFun()->getMemoryReport(); });
       ++numSuccess;
       //std::cout << ".";
       //std::cout.flush();
@@ -236,6 +260,12 @@ void ModelBuilder::measureModelGen(const string& name, int numTries, function<vo
   }
   USER_INFO << numSuccess << " / " << numTries << ". MinT: " <<
     minT << ". MaxT: " << maxT << ". AvgT: " << sumT / numTries;
+  USER_INFO << "Failure rate: " << 100 * (numTries - numSuccess) / max(1, numTries) << "%";
+  if (!memoryReport.empty())
+    USER_INFO << "Tile memory:\n" << memoryReport;
+  auto& scratchStats = ScratchBuffer::getStats();
+  USER_INFO << "Scratch allocations: " << scratchStats.numAllocations << " (" << scratchStats.numBytes / (1 << 20)
+      << " MB), chunks taken from the heap: " << scratchStats.numNewChunks;
 }
 
 void ModelBuilder::makeExtraLevel(Model* model, LevelConnection& connection, SettlementInfo& mainSettlement,
@@ -252,9 +282,9 @@ void ModelBuilder::makeExtraLevel(Model* model, LevelConnection& connection, Set
         swap(settlement.upStairs, settlement.downStairs);
       auto res = model->buildLevel(
           contentFactory,
-          LevelBuilder(meter, random, contentFactory, level.levelSize.x, level.levelSize.y, true,
+          LevelBuilder(meter, *random, contentFactory, level.levelSize.x, level.levelSize.y, true,
               level.isLit ? 1.0 : 0.0),
-          getMaker(level.levelType)(random, settlement, level.levelSize, difficulty),
+          getMaker(level.levelType)(*random, settlement, level.levelSize, difficulty),
           depth,
           level.name.value_or("Z-level " + toString(depth)));
       res->canTranfer = level.canTransfer;
@@ -324,9 +354,9 @@ PModel ModelBuilder::tryModel(int width, int difficulty, vector<EnemyInfo> enemy
   append(enemyInfo, extraEnemies);
   model->buildMainLevel(
       contentFactory,
-      LevelBuilder(meter, random, contentFactory, width, width, false),
-      LevelMaker::topLevel(random, topLevelSettlements, width, difficulty, keeperTribe, std::move(keeperBase),
-          biomeInfo, *chooseResourceCounts(random, contentFactory->resources, 0), *contentFactory));
+      LevelBuilder(meter, *random, contentFactory, width, width, false),
+      LevelMaker::topLevel(*random, topLevelSettlements, width, difficulty, keeperTribe, std::move(keeperBase),
+          biomeInfo, *chooseResourceCounts(*random, contentFactory->resources, 0), *contentFactory));
   model->getGroundLevel()->sightRange = biomeInfo.sightRange;
   model->calculateStairNavigation();
   for (auto& enemy : enemyInfo)
@@ -342,7 +372,7 @@ PModel ModelBuilder::battleModel(const FilePath& levelPath, vector<PCreature> al
   Table<char> level = *SokobanInput::readTable(stream);
   Level* l = m->buildMainLevel(
       contentFactory,
-      LevelBuilder(meter, Random, contentFactory, level.getBounds().width(), level.getBounds().height(), true, 1.0),
+      LevelBuilder(meter, *random, contentFactory, level.getBounds().width(), level.getBounds().height(), true, 1.0),
       LevelMaker::battleLevel(level, std::move(allies), enemies));
   return m;
 }
@@ -41,7 +41,7 @@ class ModelBuilder {
   ~ModelBuilder();
 
   private:
-  void measureModelGen(const std::string& name, int numTries, function<void()> genFun);
+  void measureModelGen(const std::string& name, int numTries, function<PModel()> genFun);
   PModel tryCampaignBaseModel(TribeAlignment, optional<KeeperBaseInfo>, BiomeId, optional<ExternalEnemiesType>);
   PModel tryTutorialModel(optional<KeeperBaseInfo>);
   PModel tryCampaignSiteModel(EnemyId, VillainType, TribeAlignment, BiomeId, int difficulty);
@@ -50,8 +50,10 @@ class ModelBuilder {
   void makeExtraLevel(Model* model, LevelConnection& connection, SettlementInfo& mainSettlement, StairKey upLink,
       vector<EnemyInfo>& extraEnemies, int depth, bool mainDungeon, int difficulty);
   PModel tryBuilding(int numTries, function<PModel()> buildFun, const string& name);
+  // Makes the builder draw from its own generator, seeded with seed, while running fun.
+  void runSeeded(int seed, function<void()> fun);
   void addMapVillains(vector<EnemyInfo>&, const vector<BiomeEnemyInfo>&);
-  RandomGen& random;
+  RandomGen* random;
   ProgressMeter* meter = nullptr;
   HeapAllocated<EnemyFactory> enemyFactory;
   SokobanInput* sokobanInput = nullptr;
@@ -183,40 +183,41 @@ class EffectsAI : public Behaviour {
   virtual MoveInfo getMove() {
     PROFILE_BLOCK("EffectsAI::getMove");
     MoveInfo ret = NoMove;
-    for (auto spell : creature->getSpellMap().getAvailable(creature))
-      if (!spell->getEffect().isOffensive() || !creature->getVisibleEnemies().empty())
+    for (auto spell : creature->getSpellMap().getAvailable(creature)) {
+      auto& aiInfo = spell->getEffect().getAIInfo();
+      if (aiInfo.canApply && (!aiInfo.offensive || !creature->getVisibleEnemies().empty()))
         spell->getAIMove(creature, ret);
+    }
     // prevent workers from using up items that they're hauling
     if (!creature->getStatus().contains(CreatureStatus::CIVILIAN))
       for (auto item : creature->getEquipment().getItems())
-        if (canUseItem(item))
-          if (auto effect = item->getEffect())
-            if (!effect->isOffensive() || !creature->getVisibleEnemies().empty()) {
-              {
-                auto name = "Apply item " + item->getName();
-                PROFILE_BLOCK(name.data());
+        if (auto& effect = item->getEffect()) {
+          auto& aiInfo = effect->getAIInfo();
+          if (aiInfo.canApply && (!aiInfo.offensive || !creature->getVisibleEnemies().empty()) && canUseItem(item)) {
+            {
+              PROFILE_BLOCK("Apply item");
               auto value = effect->shouldAIApply(creature, creature->getPosition());
               if (value > 0)
                 if (auto move = creature->applyItem(item))
                   tryMove(ret, value, std::move(move));
-              }
-              {
-              auto name = "Give item " + item->getName();
-              PROFILE_BLOCK(name.data());
+            }
+            {
+              PROFILE_BLOCK("Give item");
               for (Position pos : creature->getPosition().neighbors8())
                 if (Creature* c = pos.getCreature())
                   if (creature->isFriend(c) && effect->shouldAIApply(c, c->getPosition()) > 0 &&
                       c->getEquipment().getItems().filter(Item::namePredicate(item->getName())).empty())
                     if (auto action = creature->give(c, {item}))
                       tryMove(ret, 1, action);
-              }
             }
+          }
+        }
     {
       PROFILE_BLOCK("Throw item");
       for (auto item : creature->getEquipment().getItems())
         if (canUseItem(item) && item->effectAppliedWhenThrown())
-          if (auto effect = item->getEffect())
-            if (effect->isOffensive())
+          if (auto& effect = item->getEffect())
+            if (effect->getAIInfo().offensive)
               for (auto c : creature->getVisibleEnemies())
                 getThrowMove(c, ret, item);
     }
@@ -470,7 +471,7 @@ class Fighter : public Behaviour {
 
   MoveInfo considerBreakingChokePoint(Creature* other) {
   PROFILE;
-    HashSet<Position> myNeighbors;
+    PositionSet myNeighbors;
     for (auto pos : creature->getPosition().neighbors8(Random))
       myNeighbors.insert(pos);
     MoveInfo destroyMove = NoMove;
@@ -1207,24 +1208,38 @@ MonsterAI::MonsterAI(Creature* c, const vector<Behaviour*>& beh, const vector<in
 void MonsterAI::makeMove() {
   PROFILE;
   vector<MoveInfo> moves;
+  // Item stacks that can be picked up are the same for every behaviour, so they are computed once.
+  optional<vector<pair<Item*, CreatureAction>>> pickUpOptions;
+  auto getPickUpOptions = [&] () -> const vector<pair<Item*, CreatureAction>>& {
+    if (!pickUpOptions) {
+      pickUpOptions.emplace();
+      for (auto& stack : Item::stackItems(creature->getGame()->getContentFactory(), creature->getPickUpOptions())) {
+        Item* item = stack[0];
+        if (!item->isOrWasForSale())
+          if (auto action = creature->pickUp(stack))
+            pickUpOptions->push_back(make_pair(item, std::move(action)));
+      }
+    }
+    return *pickUpOptions;
+  };
+  double bestValue = 0;
   for (int i : All(behaviours)) {
+    if (i > 0)
+      CHECK(weights[i - 1] >= weights[i]);
+    // A behaviour's moves are worth at most its weight, and ties go to earlier moves, so the remaining behaviours
+    // can't produce the winner.
+    if (bestValue >= weights[i])
+      break;
     MoveInfo move = behaviours[i]->getMove();
     move.setValue(max(0.0, min(1.0, move.getValue())) * weights[i]);
+    bestValue = max(bestValue, move.getValue());
     moves.push_back(move);
-    bool skipNextMoves = false;
-    if (i < behaviours.size() - 1) {
-      CHECK(weights[i] >= weights[i + 1]);
-      if (moves.back().getValue() > weights[i + 1])
-        skipNextMoves = true;
-    }
     if (pickItems)
-      for (auto& stack : Item::stackItems(creature->getGame()->getContentFactory(), creature->getPickUpOptions())) {
-        Item* item = stack[0];
-        if (!item->isOrWasForSale() && creature->pickUp(stack))
-          moves.push_back(MoveInfo({ behaviours[i]->itemValue(item) * weights[i], creature->pickUp(stack)}));
-      }
-    if (skipNextMoves)
-      break;
+      for (auto& option : getPickUpOptions())
+        if (auto value = behaviours[i]->itemValue(option.first) * weights[i]) {
+          moves.push_back(MoveInfo({value, option.second}));
+          bestValue = max(bestValue, value);
+        }
   }
   /*vector<Item*> inventory = creature->getEquipment().getItems([this](Item* item) { return !creature->getEquipment().isEquiped(item);});
   for (Item* item : inventory) {
@@ -0,0 +1,29 @@
+#include "stdafx.h"
+#include "move_cache.h"
+
+// The counters are only for benchmarks and aren't synchronized.
+static map<string, MoveCacheStats>& getAllStats() {
+  static map<string, MoveCacheStats> ret;
+  return ret;
+}
+
+MoveCacheStats& getMoveCacheStats(const char* name) {
+  return getAllStats()[name];
+}
+
+string getMoveCacheReport() {
+  string ret;
+  for (auto& elem : getAllStats()) {
+    auto total = elem.second.hits + elem.second.misses;
+    ret += elem.first + ": " + toString(elem.second.hits) + "/" + toString(total) + " hits";
+    if (total > 0)
+      ret += " (" + toString(elem.second.hits * 100 / total) + "%)";
+    ret += "\n";
+  }
+  return ret;
+}
+
+void resetMoveCacheStats() {
+  for (auto& elem : getAllStats())
+    elem.second = MoveCacheStats{};
+}
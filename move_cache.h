@@ -0,0 +1,39 @@
+#pragma once
+
+#include "util.h"
+
+struct MoveCacheStats {
+  long long hits = 0;
+  long long misses = 0;
+};
+
+// Counted since the last call to resetMoveCacheStats.
+MoveCacheStats& getMoveCacheStats(const char* name);
+string getMoveCacheReport();
+void resetMoveCacheStats();
+
+// Slot for the result of a query that is recomputed only when its key changes, typically the model's move counter,
+// or after an explicit clear(). Slots with the same name share their hit counters.
+template <typename Key, typename T>
+class MoveCache {
+  public:
+  explicit MoveCache(const char* name) : stats(&getMoveCacheStats(name)) {}
+
+  template <typename Fun>
+  const T& get(const Key& key, Fun compute) {
+    if (!value || value->first != key) {
+      ++stats->misses;
+      value.emplace(key, compute());
+    } else
+      ++stats->hits;
+    return value->second;
+  }
+
+  void clear() {
+    value.reset();
+  }
+
+  private:
+  MoveCacheStats* stats;
+  optional<pair<Key, T>> value;
+};
@@ -259,11 +259,28 @@ T* OwnerPointer<T>::get() const {
   return elem.get();
 }
 
+template <typename T, typename = void>
+struct IsSlabAllocated : std::false_type {};
+
+template <typename T>
+struct IsSlabAllocated<T, typename std::conditional<false, typename T::SlabAllocatedTag, void>::type>
+    : std::true_type {};
+
 template <typename T, typename... Args>
-OwnerPointer<T> makeOwner(Args&&... args) {
+OwnerPointer<T> makeOwnerImpl(std::false_type, Args&&... args) {
   return OwnerPointer<T>(std::make_shared<T>(std::forward<Args>(args)...));
 }
 
+template <typename T, typename... Args>
+OwnerPointer<T> makeOwnerImpl(std::true_type, Args&&... args) {
+  return OwnerPointer<T>(shared_ptr<T>(new T(std::forward<Args>(args)...)));
+}
+
+template <typename T, typename... Args>
+OwnerPointer<T> makeOwner(Args&&... args) {
+  return makeOwnerImpl<T>(IsSlabAllocated<T>(), std::forward<Args>(args)...);
+}
+
 template<class T>
 auto getWeakPointers(const vector<OwnerPointer<T>>& v) {
   vector<decltype(v[0].get())> ret;
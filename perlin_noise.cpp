@@ -1,66 +1,101 @@
 #include "util.h"
 #include "perlin_noise.h"
 
-void addAvg(int x, int y, const Table<double>& wys, double& avg, int& num) {
-  Vec2 pos(x, y);
-  if (pos.inRectangle(wys.getBounds())) {
-    avg += wys[pos];
-    ++num;
-  }
-}
-
+// The grid is stored column-major in a flat array. Only the outermost rows and columns of the edge midpoint steps
+// have neighbors outside of the grid, so the interior is averaged without bounds checks. The random numbers are drawn
+// and the averages are summed in the same order as in a plain per-sample implementation, so the result is identical.
 Table<double> genNoiseMap(RandomGen& random, Rectangle area, NoiseInit init, double varianceMult) {
   int width = 1;
   while (width < area.width() - 1 || width < area.height() - 1)
     width *= 2;
   width /= 2;
   ++width;
-  Table<double> wys(width, width);
-  wys[0][0] = init.topLeft;
-  wys[width - 1][0] = init.topRight;
-  wys[width - 1][width - 1] = init.bottomRight;
-  wys[0][width - 1] = init.bottomLeft;
-  wys[(width - 1) / 2][(width - 1) / 2] = init.middle;
+  vector<double> wys(width * width);
+  auto at = [&wys, width](int x, int y) -> double& { return wys[x * width + y]; };
+  at(0, 0) = init.topLeft;
+  at(width - 1, 0) = init.topRight;
+  at(width - 1, width - 1) = init.bottomRight;
+  at(0, width - 1) = init.bottomLeft;
+  at((width - 1) / 2, (width - 1) / 2) = init.middle;
 
   double variance = 0.5;
-  double heightDiff = 0.1;
   for (int a = width - 1; a >= 2; a /= 2) {
+    const int half = a / 2;
+    const int numCells = (width - 1) / a;
     if (a < width - 1)
-      for (Vec2 pos1 : Rectangle((width - 1) / a, (width - 1) / a)) {
-        Vec2 pos = pos1 * a;
-        double avg = (wys[pos] + wys[pos.x + a][pos.y] + wys[pos.x][pos.y + a] + wys[pos.x + a][pos.y + a]) / 4;
-        wys[pos.x + a / 2][pos.y + a / 2] =
-            avg + variance * (random.getDouble() * 2 - 1);
+      for (int x = 0; x < width - 1; x += a)
+        for (int y = 0; y < width - 1; y += a) {
+          double avg = (at(x, y) + at(x + a, y) + at(x, y + a) + at(x + a, y + a)) / 4;
+          at(x + half, y + half) = avg + variance * (random.getDouble() * 2 - 1);
+        }
+    for (int i = 0; i < numCells; ++i) {
+      int x = i * a;
+      for (int j = 0; j <= numCells; ++j) {
+        int y = j * a;
+        double avg = 0;
+        int num = 0;
+        if (j > 0) {
+          avg += at(x + half, y - half);
+          ++num;
+        }
+        avg += at(x, y);
+        avg += at(x + a, y);
+        num += 2;
+        if (j < numCells) {
+          avg += at(x + half, y + half);
+          ++num;
+        }
+        at(x + half, y) = avg / num + variance * (random.getDouble() * 2 - 1);
       }
-    for (Vec2 pos1 : Rectangle((width - 1) / a, (width - 1) / a + 1)) {
-      Vec2 pos = pos1 * a;
-      double avg = 0;
-      int num = 0;
-      addAvg(pos.x + a / 2, pos.y - a / 2, wys, avg, num);
-      addAvg(pos.x, pos.y, wys, avg, num);
-      addAvg(pos.x + a, pos.y, wys, avg, num);
-      addAvg(pos.x + a / 2, pos.y + a / 2, wys, avg, num);
-      wys[pos.x + a / 2][pos.y] =
-          avg / num + variance * (random.getDouble() * 2 - 1);
     }
-    for (Vec2 pos1 : Rectangle((width - 1) / a + 1, (width - 1) / a)) {
-      Vec2 pos = pos1 * a;
-      double avg = 0;
-      int num = 0;
-      addAvg(pos.x - a / 2, pos.y + a / 2, wys, avg, num);
-      addAvg(pos.x, pos.y, wys, avg, num);
-      addAvg(pos.x, pos.y + a , wys, avg, num);
-      addAvg(pos.x + a / 2, pos.y + a / 2, wys, avg, num);
-      wys[pos.x][pos.y + a / 2] =
-          avg / num + variance * (random.getDouble() * 2 - 1);
+    for (int i = 0; i <= numCells; ++i) {
+      int x = i * a;
+      for (int j = 0; j < numCells; ++j) {
+        int y = j * a;
+        double avg = 0;
+        int num = 0;
+        if (i > 0) {
+          avg += at(x - half, y + half);
+          ++num;
+        }
+        avg += at(x, y);
+        avg += at(x, y + a);
+        num += 2;
+        if (i < numCells) {
+          avg += at(x + half, y + half);
+          ++num;
+        }
+        at(x, y + half) = avg / num + variance * (random.getDouble() * 2 - 1);
+      }
     }
     variance *= varianceMult;
   }
   Table<double> ret(area);
   Vec2 offset(area.left(), area.top());
-  for (Vec2 v : area) {
-    Vec2 lv((v.x - offset.x) * width / area.width(), (v.y - offset.y) * width / area.height());
-    ret[v] = wys[lv];
+  for (Vec2 v : area)
+    ret[v] = at((v.x - offset.x) * width / area.width(), (v.y - offset.y) * width / area.height());
+  return ret;
+}
+
+vector<double> getSortedValues(const Table<double>& table, const vector<int>& indices) {
+  std::vector<double> values;
+  values.reserve(table.getBounds().area());
+  for (Vec2 v : table.getBounds())
+    values.push_back(table[v]);
+  vector<int> order(indices.size());
+  for (int i : All(order))
+    order[i] = i;
+  sort(order.begin(), order.end(), [&](int i1, int i2) { return indices[i1] < indices[i2]; });
+  vector<double> ret(indices.size());
+  int begin = 0;
+  for (int i : order) {
+    int index = indices[i];
+    CHECK(index >= 0 && index < values.size());
+    if (index >= begin) {
+      std::nth_element(values.begin() + begin, values.begin() + index, values.end());
+      begin = index + 1;
+    }
+    ret[i] = values[index];
   }
   return ret;
 }
@@ -12,3 +12,7 @@ struct NoiseInit {
 };
 
 Table<double> genNoiseMap(RandomGen& random, Rectangle area, NoiseInit, double varianceMult);
+
+// Returns the values that would be at the given indices if all values of the table were sorted. Uses partial
+// selection instead of sorting the whole table.
+vector<double> getSortedValues(const Table<double>&, const vector<int>& indices);
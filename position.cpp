@@ -31,6 +31,7 @@
 #include "vision.h"
 #include "tile_gas.h"
 #include "tile_gas_info.h"
+#include "light_map.h"
 #include "attack.h"
 #include "attack_level.h"
 #include "zlevel.h"
@@ -436,7 +437,14 @@ string Position::getName() const {
 void Position::getViewIndex(ViewIndex& index, const Creature* viewer) const {
   PROFILE;
   if (isValid()) {
-    getSquare()->getViewIndex(getGame()->getContentFactory(), index, viewer);
+    auto factory = getGame()->getContentFactory();
+    getSquare()->getViewIndex(factory, index, viewer);
+    CHECK(index.getGasAmounts().empty());
+    for (auto& type : factory->tileGasTypes) {
+      auto amount = level->tileGas->getAmount(coord, type.first);
+      if (amount > 0)
+        index.addGasAmount(type.second.name, type.second.color.transparency(amount * 255));
+    }
     if (isUnavailable())
       index.setHighlight(HighlightType::UNAVAILABLE);
     if (isCovered())
@@ -546,7 +554,7 @@ bool Position::canEnterEmptyCalc(const MovementType& t, optional<FurnitureLayer>
     return false;
   const auto square = getSquare();
   bool result = true;
-  const bool covered = isCovered() || getSquare()->hasSunlightBlockingGasAmount();
+  const bool covered = isCovered() || level->tileGas->hasSunlightBlockingAmount(coord);
   for (auto layer : ENUM_ALL(FurnitureLayer))
     if (layer != ignore)
       if (auto furniture = level->furniture->getBuilt(layer).getReadonly(coord)) {
@@ -756,6 +764,7 @@ void Position::removeFurniture(const Furniture* f, PFurniture replace, Creature*
   } else {
     level->furniture->getBuilt(layer).clearElem(coord);
     level->furniture->eraseConstruction(coord, layer);
+    level->onFurnitureChanged(coord);
   }
   updateMovementDueToFire();
   updateConnectivity();
@@ -967,14 +976,16 @@ vector<Position> Position::getVisibleTiles(const Vision& vision) {
 
 void Position::addGas(TileGasType type, double amount) {
   PROFILE;
-  if (isValid())
-    modSquare()->addGas(*this, type, amount);
+  if (isValid() && canSeeThruIgnoringGas(VisionId::NORMAL)) {
+    level->tileGas->addAmount(*this, type, amount);
+    setNeedsRenderAndMemoryUpdate(true);
+  }
 }
 
 double Position::getGasAmount(TileGasType type) const {
   PROFILE;
   if (isValid())
-    return getSquare()->getGasAmount(type);
+    return level->tileGas->getAmount(coord, type);
   else
     return 0;
 }
@@ -993,8 +1004,8 @@ bool Position::isCovered() const {
 
 bool Position::sunlightBurns() const {
   PROFILE;
-  return isValid() && !isCovered() && level->lightCapAmount[coord] >= 1 &&
-      getGame()->getSunlightInfo().getState() == SunlightState::DAY && !getSquare()->hasSunlightBlockingGasAmount();
+  return isValid() && !isCovered() && level->lightMap->getLightCapAmount(coord) >= 1 &&
+      getGame()->getSunlightInfo().getState() == SunlightState::DAY && !level->tileGas->hasSunlightBlockingAmount(coord);
 }
 
 double Position::getLightEmission() const {
@@ -1187,7 +1198,7 @@ bool Position::canSeeThru(VisionId id, const ContentFactory* factory) const {
   if (!isValid() || !canSeeThruIgnoringGas(id))
     return false;
   for (auto& type : factory->tileGasTypes)
-    if (type.second.blocksVision && getSquare()->getGasAmount(type.first) >= TileGas::getFogVisionCutoff())
+    if (type.second.blocksVision && level->tileGas->getAmount(coord, type.first) >= TileGas::getFogVisionCutoff())
       return false;
   return true;
 }
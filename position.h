@@ -186,4 +186,4 @@ inline string toString(const Position& t) {
   return ss.str();
 }
 
-using PositionSet = HashSet<Position>;
+#include "position_set.h"
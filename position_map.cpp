@@ -26,32 +26,54 @@ static optional<const T&> getReferenceOptional(const heap_optional<T>& t) {
     return none;
 }
 
+template <class T>
+const typename PositionMap<T>::LevelData* PositionMap<T>::getLevelData(const Level* level) const {
+  LevelId levelId = level->getUniqueId();
+  if (lastLevel < levels.size() && levels[lastLevel].levelId == levelId)
+    return &levels[lastLevel];
+  for (int i : All(levels))
+    if (levels[i].levelId == levelId) {
+      lastLevel = i;
+      return &levels[i];
+    }
+  return nullptr;
+}
+
+template <class T>
+typename PositionMap<T>::LevelData* PositionMap<T>::getLevelData(const Level* level) {
+  return const_cast<LevelData*>(static_cast<const PositionMap*>(this)->getLevelData(level));
+}
+
+template <class T>
+typename PositionMap<T>::LevelData& PositionMap<T>::getOrInitLevelData(Position pos) {
+  if (auto data = getLevelData(pos.getLevel()))
+    return *data;
+  lastLevel = levels.size();
+  levels.push_back(LevelData{pos.getLevel()->getUniqueId(),
+      Table<heap_optional<T>>(pos.getLevel()->getBounds().minusMargin(-2)), {}});
+  return levels.back();
+}
+
 template <class T>
 optional<const T&> PositionMap<T>::getReferenceMaybe(Position pos) const {
-  LevelId levelId = pos.getLevel()->getUniqueId();
-  try {
-    const auto& table = tables.at(levelId);
-    if (pos.getCoord().inRectangle(table.getBounds()))
-      return getReferenceOptional(table[pos.getCoord()]);
+  if (auto data = getLevelData(pos.getLevel())) {
+    if (pos.getCoord().inRectangle(data->table.getBounds()))
+      return getReferenceOptional(data->table[pos.getCoord()]);
     else
-      return outliers.at(levelId).at(pos.getCoord());
-  } catch (std::out_of_range) {
-    return none;
+      return ::getReferenceMaybe(data->outliers, pos.getCoord());
   }
+  return none;
 }
 
 template <class T>
 optional<T&> PositionMap<T>::getReferenceMaybe(Position pos) {
-  LevelId levelId = pos.getLevel()->getUniqueId();
-  try {
-    auto& table = tables.at(levelId);
-    if (pos.getCoord().inRectangle(table.getBounds()))
-      return getReferenceOptional(table[pos.getCoord()]);
+  if (auto data = getLevelData(pos.getLevel())) {
+    if (pos.getCoord().inRectangle(data->table.getBounds()))
+      return getReferenceOptional(data->table[pos.getCoord()]);
     else
-      return outliers.at(levelId).at(pos.getCoord());
-  } catch (std::out_of_range) {
-    return none;
+      return ::getReferenceMaybe(data->outliers, pos.getCoord());
   }
+  return none;
 }
 
 template<class T>
@@ -67,73 +89,49 @@ bool PositionMap<T>::contains(Position pos) const {
   return !!getReferenceMaybe(pos);
 }
 
-template <class T>
-Table<heap_optional<T>>& PositionMap<T>::getTable(Position pos) {
-  LevelId levelId = pos.getLevel()->getUniqueId();
-  try {
-    return tables.at(levelId);
-  } catch (std::out_of_range) {
-    auto it = tables.insert(make_pair(levelId, Table<heap_optional<T>>(pos.getLevel()->getBounds().minusMargin(-2))));
-    return it.first->second;
-  }
-}
-
 template <class T>
 T& PositionMap<T>::getOrInit(Position pos) {
-  LevelId levelId = pos.getLevel()->getUniqueId();
-  auto& table = getTable(pos);
-  if (pos.getCoord().inRectangle(table.getBounds())) {
-    if (!table[pos.getCoord()])
-      table[pos.getCoord()] = T();
-    return *table[pos.getCoord()];
-  }
-  else try {
-    return outliers.at(levelId).at(pos.getCoord());
-  } catch (std::out_of_range) {
-    return outliers[levelId][pos.getCoord()] = T();
-  }
+  auto& data = getOrInitLevelData(pos);
+  if (pos.getCoord().inRectangle(data.table.getBounds())) {
+    auto& elem = data.table[pos.getCoord()];
+    if (!elem)
+      elem = T();
+    return *elem;
+  } else
+    return data.outliers[pos.getCoord()];
 }
 
 template <class T>
 T& PositionMap<T>::getOrFail(Position pos) {
-  LevelId levelId = pos.getLevel()->getUniqueId();
-  auto& table = tables.at(levelId);
-  if (pos.getCoord().inRectangle(table.getBounds()))
-    return *table[pos.getCoord()];
-  else
-    return outliers.at(levelId).at(pos.getCoord());
+  auto ret = getReferenceMaybe(pos);
+  CHECK(!!ret);
+  return *ret;
 }
 
 template <class T>
 const T& PositionMap<T>::getOrFail(Position pos) const {
-  LevelId levelId = pos.getLevel()->getUniqueId();
-  auto& table = tables.at(levelId);
-  if (pos.getCoord().inRectangle(table.getBounds()))
-    return *table[pos.getCoord()];
-  else
-    return outliers.at(levelId).at(pos.getCoord());
+  auto ret = getReferenceMaybe(pos);
+  CHECK(!!ret);
+  return *ret;
 }
 
 template <class T>
 void PositionMap<T>::set(Position pos, const T& elem) {
-  LevelId levelId = pos.getLevel()->getUniqueId();
-  auto& table = getTable(pos);
-  if (pos.getCoord().inRectangle(table.getBounds()))
-    table[pos.getCoord()] = elem;
+  auto& data = getOrInitLevelData(pos);
+  if (pos.getCoord().inRectangle(data.table.getBounds()))
+    data.table[pos.getCoord()] = elem;
   else
-    outliers[levelId][pos.getCoord()] = elem;
+    data.outliers[pos.getCoord()] = elem;
 }
 
 template<class T>
 void PositionMap<T>::erase(Position pos) {
-  LevelId levelId = pos.getLevel()->getUniqueId();
-  if (auto table = ::getReferenceMaybe(tables, levelId))
-    if (pos.getCoord().inRectangle(table->getBounds()))
-      (*table)[pos.getCoord()] = none;
-  if (auto out = ::getReferenceMaybe(outliers, levelId))
-    if (auto elem = ::getReferenceMaybe(*out, pos.getCoord()))
-      elem = none;
-
+  if (auto data = getLevelData(pos.getLevel())) {
+    if (pos.getCoord().inRectangle(data->table.getBounds()))
+      data->table[pos.getCoord()] = none;
+    else
+      data->outliers.erase(pos.getCoord());
+  }
 }
 
 template <class T>
@@ -141,23 +139,21 @@ void PositionMap<T>::limitToModel(const Model* m) {
   std::set<LevelId> goodIds;
   for (Level* l : m->getLevels())
     goodIds.insert(l->getUniqueId());
-  for (auto& elem : copyOf(tables))
-    if (!goodIds.count(elem.first))
-      tables.erase(elem.first);
-  for (auto& elem : copyOf(outliers))
-    if (!goodIds.count(elem.first))
-      outliers.erase(elem.first);
+  for (int i : All(levels).reverse())
+    if (!goodIds.count(levels[i].levelId))
+      levels.removeIndexPreserveOrder(i);
+  lastLevel = 0;
 }
 
 template <class T>
 template <class Archive>
 void PositionMap<T>::serialize(Archive& ar, const unsigned int version) {
-  ar(tables, outliers);
+  ar(levels);
 }
 
 template <class T>
 bool PositionMap<T>::containsLevel(const Level* l) const {
-  return tables.count(l->getUniqueId()) || outliers.count(l->getUniqueId());
+  return !!getLevelData(l);
 }
 
 template <class T>
@@ -178,4 +174,5 @@ SERIALIZABLE_TMPL(PositionMap, vector<Position>)
 SERIALIZABLE_TMPL(PositionMap, ConstructionMap::FurnitureInfo);
 SERIALIZABLE_TMPL(PositionMap, EnumMap<FurnitureLayer, optional<FurnitureType>>)
 SERIALIZABLE_TMPL(PositionMap, Position)
+SERIALIZABLE_TMPL(PositionMap, PositionSet)
 
@@ -23,8 +23,17 @@ class PositionMap {
   SERIALIZATION_DECL(PositionMap)
 
   private:
-  Table<heap_optional<T> >& getTable(Position);
-  map<LevelId, Table<heap_optional<T>>> SERIAL(tables);
-  map<LevelId, map<Vec2, T>> SERIAL(outliers);
+  struct LevelData {
+    LevelId SERIAL(levelId);
+    Table<heap_optional<T>> SERIAL(table);
+    map<Vec2, T> SERIAL(outliers);
+    SERIALIZE_ALL(levelId, table, outliers)
+  };
+  // Levels are few, so a flat vector with a cached last hit beats a map lookup on every access.
+  const LevelData* getLevelData(const Level*) const;
+  LevelData* getLevelData(const Level*);
+  LevelData& getOrInitLevelData(Position);
+  vector<LevelData> SERIAL(levels);
+  mutable int lastLevel = 0;
 };
 
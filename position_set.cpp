@@ -0,0 +1,240 @@
+#include "stdafx.h"
+#include "position_set.h"
+
+int PositionSet::getLowestBit(uint64_t v) {
+  return __builtin_ctzll(v);
+}
+
+Vec2 PositionSet::getChunkCoord(Vec2 v) {
+  return Vec2(v.x >> chunkBits, v.y >> chunkBits);
+}
+
+uint64_t PositionSet::getChunkBit(Vec2 v) {
+  return uint64_t(1) << (((v.x & (chunkSize - 1)) << chunkBits) + (v.y & (chunkSize - 1)));
+}
+
+Vec2 PositionSet::getChunkOrigin(const LevelSet& set, int chunkIndex) {
+  auto& bounds = set.chunkBounds;
+  return Vec2(bounds.left() + chunkIndex / bounds.height(), bounds.top() + chunkIndex % bounds.height()) * chunkSize;
+}
+
+uint64_t* PositionSet::LevelSet::getChunk(Vec2 chunk) {
+  if (!chunk.inRectangle(chunkBounds))
+    return nullptr;
+  return &chunks[(chunk.x - chunkBounds.left()) * chunkBounds.height() + chunk.y - chunkBounds.top()];
+}
+
+const uint64_t* PositionSet::LevelSet::getChunk(Vec2 chunk) const {
+  if (!chunk.inRectangle(chunkBounds))
+    return nullptr;
+  return &chunks[(chunk.x - chunkBounds.left()) * chunkBounds.height() + chunk.y - chunkBounds.top()];
+}
+
+uint64_t& PositionSet::LevelSet::getOrInitChunk(Vec2 chunk) {
+  if (auto ret = getChunk(chunk))
+    return *ret;
+  // Leave some slack around the new chunk so that sets growing by flood fill don't reallocate on every step.
+  const int margin = 2;
+  auto newBounds = chunkBounds.empty()
+      ? Rectangle::centered(chunk, margin)
+      : Rectangle(min(chunkBounds.left(), chunk.x - margin), min(chunkBounds.top(), chunk.y - margin),
+          max(chunkBounds.right(), chunk.x + margin + 1), max(chunkBounds.bottom(), chunk.y + margin + 1));
+  vector<uint64_t> newChunks(newBounds.area());
+  for (int x : Range(chunkBounds.left(), chunkBounds.right()))
+    for (int y : Range(chunkBounds.top(), chunkBounds.bottom()))
+      newChunks[(x - newBounds.left()) * newBounds.height() + y - newBounds.top()] =
+          chunks[(x - chunkBounds.left()) * chunkBounds.height() + y - chunkBounds.top()];
+  chunks = std::move(newChunks);
+  chunkBounds = newBounds;
+  return *getChunk(chunk);
+}
+
+PositionSet::LevelSet* PositionSet::getLevelSet(const Level* level) {
+  return const_cast<LevelSet*>(static_cast<const PositionSet*>(this)->getLevelSet(level));
+}
+
+const PositionSet::LevelSet* PositionSet::getLevelSet(const Level* level) const {
+  if (lastLevel < levels.size() && levels[lastLevel].level == level)
+    return &levels[lastLevel];
+  for (int i : All(levels))
+    if (levels[i].level == level) {
+      lastLevel = i;
+      return &levels[i];
+    }
+  return nullptr;
+}
+
+bool PositionSet::insert(const Position& pos) {
+  auto set = getLevelSet(pos.getLevel());
+  if (!set) {
+    lastLevel = levels.size();
+    levels.push_back(LevelSet{pos.getLevel(), Rectangle(0, 0), {}, {}, 0});
+    set = &levels.back();
+  }
+  if (!pos.isValid()) {
+    if (set->outliers.contains(pos))
+      return false;
+    set->outliers.push_back(pos);
+  } else {
+    auto& chunk = set->getOrInitChunk(getChunkCoord(pos.getCoord()));
+    auto bit = getChunkBit(pos.getCoord());
+    if (chunk & bit)
+      return false;
+    chunk |= bit;
+  }
+  ++set->count;
+  ++totalCount;
+  return true;
+}
+
+int PositionSet::erase(const Position& pos) {
+  auto set = getLevelSet(pos.getLevel());
+  if (!set)
+    return 0;
+  if (!pos.isValid()) {
+    auto index = set->outliers.findElement(pos);
+    if (!index)
+      return 0;
+    set->outliers.removeIndexPreserveOrder(*index);
+  } else {
+    auto chunk = set->getChunk(getChunkCoord(pos.getCoord()));
+    auto bit = getChunkBit(pos.getCoord());
+    if (!chunk || !(*chunk & bit))
+      return 0;
+    *chunk &= ~bit;
+  }
+  --set->count;
+  --totalCount;
+  return 1;
+}
+
+int PositionSet::count(const Position& pos) const {
+  return contains(pos) ? 1 : 0;
+}
+
+bool PositionSet::contains(const Position& pos) const {
+  auto set = getLevelSet(pos.getLevel());
+  if (!set || set->count == 0)
+    return false;
+  if (!pos.isValid())
+    return set->outliers.contains(pos);
+  auto chunk = set->getChunk(getChunkCoord(pos.getCoord()));
+  return chunk && (*chunk & getChunkBit(pos.getCoord()));
+}
+
+int PositionSet::size() const {
+  return totalCount;
+}
+
+bool PositionSet::empty() const {
+  return totalCount == 0;
+}
+
+void PositionSet::clear() {
+  levels.clear();
+  lastLevel = 0;
+  totalCount = 0;
+}
+
+bool PositionSet::operator == (const PositionSet& other) const {
+  if (size() != other.size())
+    return false;
+  for (auto& pos : *this)
+    if (!other.contains(pos))
+      return false;
+  return true;
+}
+
+bool PositionSet::operator != (const PositionSet& other) const {
+  return !(*this == other);
+}
+
+vector<Position> PositionSet::asVector() const {
+  vector<Position> ret;
+  ret.reserve(size());
+  for (auto& pos : *this)
+    ret.push_back(pos);
+  return ret;
+}
+
+PositionSet::const_iterator PositionSet::begin() const {
+  return const_iterator(this, 0);
+}
+
+PositionSet::const_iterator PositionSet::end() const {
+  return const_iterator(this, levels.size());
+}
+
+PositionSet::const_iterator::const_iterator(const PositionSet* s, int index) : set(s), levelIndex(index) {
+  if (levelIndex < set->levels.size() && !set->levels[levelIndex].chunks.empty())
+    remaining = set->levels[levelIndex].chunks[0];
+  findValid();
+}
+
+void PositionSet::const_iterator::findValid() {
+  while (levelIndex < set->levels.size()) {
+    auto& level = set->levels[levelIndex];
+    if (outlierIndex == -1) {
+      while (remaining == 0 && ++chunkIndex < level.chunks.size())
+        remaining = level.chunks[chunkIndex];
+      if (remaining != 0) {
+        int bit = getLowestBit(remaining);
+        current = Position(getChunkOrigin(level, chunkIndex) + Vec2(bit >> chunkBits, bit & (chunkSize - 1)),
+            level.level, Position::IsValid{});
+        return;
+      }
+      outlierIndex = 0;
+    }
+    if (outlierIndex < level.outliers.size()) {
+      current = level.outliers[outlierIndex];
+      return;
+    }
+    ++levelIndex;
+    chunkIndex = 0;
+    outlierIndex = -1;
+    remaining = levelIndex < set->levels.size() && !set->levels[levelIndex].chunks.empty()
+        ? set->levels[levelIndex].chunks[0] : 0;
+  }
+}
+
+const Position& PositionSet::const_iterator::operator* () const {
+  return current;
+}
+
+const Position* PositionSet::const_iterator::operator-> () const {
+  return &current;
+}
+
+PositionSet::const_iterator& PositionSet::const_iterator::operator++ () {
+  if (outlierIndex == -1)
+    remaining &= remaining - 1;
+  else
+    ++outlierIndex;
+  findValid();
+  return *this;
+}
+
+bool PositionSet::const_iterator::operator == (const const_iterator& o) const {
+  return levelIndex == o.levelIndex && chunkIndex == o.chunkIndex && remaining == o.remaining &&
+      outlierIndex == o.outlierIndex;
+}
+
+bool PositionSet::const_iterator::operator != (const const_iterator& o) const {
+  return !(*this == o);
+}
+
+template <class Archive>
+void PositionSet::serialize(Archive& ar1, const unsigned int) {
+  if (Archive::is_loading::value) {
+    vector<Position> all;
+    ar1(all);
+    clear();
+    for (auto& pos : all)
+      insert(pos);
+  } else {
+    auto all = asVector();
+    ar1(all);
+  }
+}
+
+SERIALIZABLE(PositionSet)
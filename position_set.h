@@ -0,0 +1,143 @@
+#pragma once
+
+#include "util.h"
+#include "position.h"
+
+// Set of positions stored as a bitset per level. Each level keeps a dense grid of 8x8 tile chunks that grows to the
+// bounding box of its contents, so membership tests are a couple of array lookups and iteration goes in spatial order.
+class PositionSet {
+  public:
+  PositionSet() {}
+  template <typename Iter>
+  PositionSet(Iter begin, Iter end) {
+    for (; begin != end; ++begin)
+      insert(*begin);
+  }
+
+  // Returns true if the position wasn't in the set.
+  bool insert(const Position&);
+  // Returns the number of removed elements.
+  int erase(const Position&);
+  int count(const Position&) const;
+  bool contains(const Position&) const;
+  int size() const;
+  bool empty() const;
+  void clear();
+  bool operator == (const PositionSet&) const;
+  bool operator != (const PositionSet&) const;
+
+  class const_iterator {
+    public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Position;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Position*;
+    using reference = const Position&;
+
+    const Position& operator* () const;
+    const Position* operator-> () const;
+    const_iterator& operator++ ();
+    bool operator == (const const_iterator&) const;
+    bool operator != (const const_iterator&) const;
+
+    private:
+    friend class PositionSet;
+    const_iterator(const PositionSet*, int levelIndex);
+    void findValid();
+    const PositionSet* set;
+    int levelIndex;
+    int chunkIndex = 0;
+    uint64_t remaining = 0;
+    int outlierIndex = -1;
+    Position current;
+  };
+  using iterator = const_iterator;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  template <typename Fun>
+  auto transform(Fun fun) const {
+    vector<decltype(fun(std::declval<Position>()))> ret;
+    ret.reserve(size());
+    for (const auto& elem : *this)
+      ret.push_back(fun(elem));
+    return ret;
+  }
+
+  template <typename Fun>
+  PositionSet filter(Fun fun) const {
+    PositionSet ret;
+    for (const auto& elem : *this)
+      if (fun(elem))
+        ret.insert(elem);
+    return ret;
+  }
+
+  vector<Position> asVector() const;
+
+  // Calls onAdded for positions that are in 'to' but not in 'from', and onRemoved for the opposite. Chunks are
+  // compared a word at a time, so positions present in both sets cost nothing.
+  template <typename AddedFun, typename RemovedFun>
+  static void getDifference(const PositionSet& from, const PositionSet& to, AddedFun onAdded, RemovedFun onRemoved);
+
+  template <class Archive>
+  void serialize(Archive&, const unsigned int);
+
+  private:
+  static constexpr int chunkBits = 3;
+  static constexpr int chunkSize = 1 << chunkBits;
+  struct LevelSet {
+    Level* level;
+    // Chunk grid, in chunk coordinates, stored column-major.
+    Rectangle chunkBounds;
+    vector<uint64_t> chunks;
+    // Positions that aren't valid on their level keep their own flag, so they are stored as they came.
+    vector<Position> outliers;
+    int count = 0;
+    uint64_t* getChunk(Vec2);
+    const uint64_t* getChunk(Vec2) const;
+    uint64_t& getOrInitChunk(Vec2);
+  };
+  static int getLowestBit(uint64_t);
+  static Vec2 getChunkCoord(Vec2);
+  static uint64_t getChunkBit(Vec2);
+  static Vec2 getChunkOrigin(const LevelSet&, int chunkIndex);
+  LevelSet* getLevelSet(const Level*);
+  const LevelSet* getLevelSet(const Level*) const;
+  template <typename Fun>
+  static void getMissing(const PositionSet& from, const PositionSet& to, Fun);
+  vector<LevelSet> levels;
+  mutable int lastLevel = 0;
+  int totalCount = 0;
+};
+
+template <typename Fun>
+void PositionSet::getMissing(const PositionSet& from, const PositionSet& to, Fun fun) {
+  for (auto& level : from.levels) {
+    if (level.count == 0)
+      continue;
+    auto otherLevel = to.getLevelSet(level.level);
+    for (int index : All(level.chunks))
+      if (auto word = level.chunks[index]) {
+        auto origin = getChunkOrigin(level, index);
+        if (otherLevel)
+          if (auto otherWord = otherLevel->getChunk(getChunkCoord(origin)))
+            word &= ~*otherWord;
+        for (; word != 0; word &= word - 1) {
+          int bit = getLowestBit(word);
+          fun(Position(origin + Vec2(bit >> chunkBits, bit & (chunkSize - 1)), level.level, Position::IsValid{}));
+        }
+      }
+    for (auto& pos : level.outliers)
+      if (!otherLevel || !otherLevel->outliers.contains(pos))
+        fun(pos);
+  }
+}
+
+template <typename AddedFun, typename RemovedFun>
+void PositionSet::getDifference(const PositionSet& from, const PositionSet& to, AddedFun onAdded,
+    RemovedFun onRemoved) {
+  getMissing(from, to, onRemoved);
+  getMissing(to, from, onAdded);
+}
@@ -3,6 +3,10 @@
 #include "key_verifier.h"
 
 string PrettyInputArchive::positionToString(const StreamPosStack& positions) {
+  return positionToString(filenames, positions);
+}
+
+string PrettyInputArchive::positionToString(const vector<string>& filenames, const StreamPosStack& positions) {
   string allPos;
   for (auto& pos : positions)
     if (pos.line > -1) {
@@ -15,7 +19,12 @@ string PrettyInputArchive::positionToString(const StreamPosStack& positions) {
 }
 
 void PrettyInputArchive::throwException(const StreamPosStack& positions, const string& message) {
-  throw PrettyException{positionToString(positions) + message};
+  throwException(filenames, positions, message);
+}
+
+void PrettyInputArchive::throwException(const vector<string>& filenames, const StreamPosStack& positions,
+    const string& message) {
+  throw PrettyException{positionToString(filenames, positions) + message};
 }
 
 static bool contains(const vector<StreamChar>& a, const string& substring, int index) {
@@ -42,11 +51,12 @@ static vector<StreamChar> subStream(const vector<StreamChar>& s, int index, int
   return ret;
 }
 
-static vector<vector<StreamChar>> parseArgs(const vector<StreamChar>& s, int& index) {
-  vector<vector<StreamChar>> ret;
+// Advances index past a parenthesized argument list. The arguments are only copied out if ret is given, so nested
+// lists can be skipped without allocating.
+static void parseArgs(const vector<StreamChar>& s, int& index, vector<vector<StreamChar>>* ret) {
   eatWhitespace(s, index);
   if (index >= s.size())
-    return ret;
+    return;
   if (s[index].c == '(') {
     ++index;
     while (1) {
@@ -55,14 +65,14 @@ static vector<vector<StreamChar>> parseArgs(const vector<StreamChar>& s, int& in
       if (s[index].c != ')')
         beginArg = index;
       eatArgument(s, index);
-      if (beginArg) {
+      if (beginArg && ret) {
         eatWhitespace(s, *beginArg);
-        ret.push_back(subStream(s, *beginArg, index - *beginArg));
-        while (isspace(ret.back().back().c))
-          ret.back().pop_back();
+        ret->push_back(subStream(s, *beginArg, index - *beginArg));
+        while (isspace(ret->back().back().c))
+          ret->back().pop_back();
       }
       if (index >= s.size())
-        return ret;
+        return;
       if (s[index].c == ',')
         ++index;
       eatWhitespace(s, index);
@@ -71,9 +81,14 @@ static vector<vector<StreamChar>> parseArgs(const vector<StreamChar>& s, int& in
         break;
       }
       if (index >= s.size())
-        return ret;
+        return;
     }
   }
+}
+
+static vector<vector<StreamChar>> parseArgs(const vector<StreamChar>& s, int& index) {
+  vector<vector<StreamChar>> ret;
+  parseArgs(s, index, &ret);
   return ret;
 }
 
@@ -95,7 +110,7 @@ void eatArgument(const vector<StreamChar>& s, int& index) {
     if (s[index].c == ')')
       return;
     if (s[index].c == '(')
-      parseArgs(s, index);
+      parseArgs(s, index, nullptr);
     ++index;
     eatWhitespace(s, index);
     if (index >= s.size() || s[index].c == ',') {
@@ -118,6 +133,26 @@ optional<string> scanWord(const vector<StreamChar>& s, int& index) {
   return ret;
 }
 
+// Same as scanWord, but compares the word in place instead of building a string.
+static bool scanWordEquals(const vector<StreamChar>& s, int& index, const string& word) {
+  int origIndex = index;
+  while (index < s.size() && isspace(s[index].c))
+    ++index;
+  int begin = index;
+  while (index < s.size() && (isalnum(s[index].c) || s[index].c == '_'))
+    ++index;
+  if (index == begin) {
+    index = origIndex;
+    return false;
+  }
+  if (index - begin != word.size())
+    return false;
+  for (int i : Range(word.size()))
+    if (s[begin + i].c != word[i])
+      return false;
+  return true;
+}
+
 static optional<string> peekWord(const vector<StreamChar>& s, int index) {
   return scanWord(s, index);
 }
@@ -127,7 +162,8 @@ static void replaceInStream(vector<StreamChar>& s, int index, int length, const
   s.insert(index, content);
 }
 
-pair<PrettyInputArchive::DefsMap, vector<StreamChar>> PrettyInputArchive::parseDefs(const vector<StreamChar>& content) {
+pair<PrettyInputArchive::DefsMap, vector<StreamChar>> PrettyInputArchive::parseDefs(const vector<string>& filenames,
+    const vector<StreamChar>& content) {
   vector<StreamChar> ret;
   bool inQuote = false;
   optional<pair<pair<string, int>, DefInfo>> currentDef;
@@ -137,23 +173,23 @@ pair<PrettyInputArchive::DefsMap, vector<StreamChar>> PrettyInputArchive::parseD
       inQuote = !inQuote;
     if (!inQuote && contains(content, "Def", i)) {
       if (!!currentDef)
-        throwException(content[i].pos, "Definition inside another definition is not allowed");
+        throwException(filenames, content[i].pos, "Definition inside another definition is not allowed");
       i += strlen("Def");
       if (auto name = scanWord(content, i)) {
         auto beforeArgs = i;
         auto args = parseArgs(content, i);
         if (i >= content.size())
-          throwException(content[beforeArgs].pos, "Couldn't parse macro arguments");
+          throwException(filenames, content[beforeArgs].pos, "Couldn't parse macro arguments");
         currentDef = make_pair(make_pair(*name, args.size()),
             DefInfo{ i, 0, args.transform([](auto& arg) { return getString(arg); } ) });
         if (defs.count({*name, args.size()}))
-          throwException(content[i].pos, *name + " defined more than once");
+          throwException(filenames, content[i].pos, *name + " defined more than once");
       } else
-        throwException(content[i].pos, "Definition name expected");
+        throwException(filenames, content[i].pos, "Definition name expected");
       while (i < content.size() && peekWord(content, i) != "End"_s)
         ++i;
       if (i >= content.size())
-        throwException(content[currentDef->second.begin].pos, "Definition lacks an End token");
+        throwException(filenames, content[currentDef->second.begin].pos, "Definition lacks an End token");
       currentDef->second.end = i;
       defs.insert(*currentDef);
       currentDef = none;
@@ -175,22 +211,28 @@ static void append(StreamPosStack& to, const StreamPosStack& from) {
       }
 }
 
-vector<StreamChar> PrettyInputArchive::preprocess(const vector<StreamChar>& content) {
+vector<StreamChar> PrettyInputArchive::preprocess(const vector<string>& filenames, const vector<StreamChar>& content) {
   bool inQuote = false;
-  auto parseRes = parseDefs(content);
+  auto parseRes = parseDefs(filenames, content);
   auto& ret = parseRes.second;
   auto& defs = parseRes.first;
+  if (defs.empty())
+    return std::move(ret);
+  set<string> defNames;
+  for (auto& def : defs)
+    defNames.insert(def.first.first);
   for (int i = 0; i < ret.size(); ++i) {
     if (ret[i].c == '"' && (i == 0 || ret[i - 1].c != '\\'))
       inQuote = !inQuote;
     if (!inQuote) {
       auto beginCall = i;
-      if (auto name = scanWord(ret, i)) {
+      auto name = scanWord(ret, i);
+      if (name && defNames.count(*name)) {
         int argsPos = i;
         auto args = parseArgs(ret, argsPos);
         if (auto def = getReferenceMaybe(defs, make_pair(*name, args.size()))) {
           if (args.size() != def->args.size())
-            throwException(ret[argsPos].pos, "Wrong number of arguments to macro " + *name);
+            throwException(filenames, ret[argsPos].pos, "Wrong number of arguments to macro " + *name);
           auto body = subStream(content, def->begin, def->end - def->begin);
           for (auto& elem : body)
             append(elem.pos, ret[i].pos);
@@ -202,7 +244,7 @@ vector<StreamChar> PrettyInputArchive::preprocess(const vector<StreamChar>& cont
                 bodyInQuote = !bodyInQuote;
               eatWhitespace(body, bodyIndex);
               const auto beginOccurrence = bodyIndex;
-              if (!bodyInQuote && scanWord(body, bodyIndex) == def->args[argNum]) {
+              if (!bodyInQuote && scanWordEquals(body, bodyIndex, def->args[argNum])) {
                 replaceInStream(body, beginOccurrence, bodyIndex - beginOccurrence, args[argNum]);
                 bodyIndex = beginOccurrence + args[argNum].size();
               }
@@ -221,8 +263,9 @@ vector<StreamChar> PrettyInputArchive::preprocess(const vector<StreamChar>& cont
   return ret;
 }
 
-vector<StreamChar> removeFormatting(string contents, signed char filename) {
+vector<StreamChar> removeFormatting(const string& contents, signed char filename) {
   vector<StreamChar> ret;
+  ret.reserve(contents.size() + contents.size() / 4);
   auto addChar = [&ret] (StreamPos pos, char c) {
     ret.push_back(StreamChar{{std::move(pos)}, c});
   };
@@ -263,7 +306,16 @@ vector<StreamChar> removeFormatting(string contents, signed char filename) {
 static KeyVerifier dummyKeyVerifier;
 
 PrettyInputArchive::PrettyInputArchive(const vector<string>& inputs, const vector<string>& filenames, KeyVerifier* v)
-  : keyVerifier(v ? *v : dummyKeyVerifier), filenames(filenames) {
+  : PrettyInputArchive(preprocessInput(inputs, filenames), v) {
+}
+
+PrettyInputArchive::PrettyInputArchive(PrettyInput input, KeyVerifier* v)
+  : keyVerifier(v ? *v : dummyKeyVerifier), streamPos(std::move(input.positions)),
+    filenames(std::move(input.filenames)) {
+  is.str(std::move(input.text));
+}
+
+PrettyInput PrettyInputArchive::preprocessInput(const vector<string>& inputs, const vector<string>& filenames) {
   vector<StreamChar> allInput;
   if (!filenames.empty()) {
     allInput.push_back(StreamChar{{}, '{'});
@@ -275,9 +327,8 @@ PrettyInputArchive::PrettyInputArchive(const vector<string>& inputs, const vecto
     allInput.push_back(StreamChar{{}, '\n'});
     allInput.push_back(StreamChar{{}, '}'});
   }
-  auto res = preprocess(allInput);
-  streamPos = res.transform([](auto& elem) { return elem.pos; });
-  is.str(getString(res));
+  auto res = preprocess(filenames, allInput);
+  return PrettyInput{getString(res), res.transform([](auto& elem) { return elem.pos; }), filenames};
 }
 
 static auto getOpenBracket(BracketType type) {
@@ -2,19 +2,12 @@
 
 #include "extern/iomanip.h"
 #include "util.h"
+#include "pretty_input.h"
 
 struct PrettyException {
   string text;
 };
 
-struct StreamPos {
-  signed char filename;
-  short line = -1;
-  signed char column;
-};
-
-using StreamPosStack = std::array<StreamPos, 4>;
-
 struct StreamChar {
   StreamPosStack pos;
   char c;
@@ -30,6 +23,10 @@ class KeyVerifier;
 class PrettyInputArchive {
   public:
     PrettyInputArchive(const vector<string>& inputs, const vector<string>& filenames, KeyVerifier* v);
+    PrettyInputArchive(PrettyInput, KeyVerifier* v);
+
+    // Throws PrettyException.
+    static PrettyInput preprocessInput(const vector<string>& inputs, const vector<string>& filenames);
 
     string eat(const char* expected = nullptr);
 
@@ -128,10 +125,13 @@ class PrettyInputArchive {
     vector<StreamPosStack> streamPos;
     vector<string> filenames;
     void throwException(const StreamPosStack&, const string&);
+    static void throwException(const vector<string>& filenames, const StreamPosStack&, const string&);
     string positionToString(const StreamPosStack&);
+    static string positionToString(const vector<string>& filenames, const StreamPosStack&);
     using DefsMap = map<pair<string, int>, DefInfo>;
-    pair<DefsMap, vector<StreamChar>> parseDefs(const vector<StreamChar>& content);
-    vector<StreamChar> preprocess(const vector<StreamChar>& content);
+    static pair<DefsMap, vector<StreamChar>> parseDefs(const vector<string>& filenames,
+        const vector<StreamChar>& content);
+    static vector<StreamChar> preprocess(const vector<string>& filenames, const vector<StreamChar>& content);
 };
 
 template<typename T, typename int_<decltype(serialize(std::declval<PrettyInputArchive&>(), std::declval<T&>()))>::type = 0>
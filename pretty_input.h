@@ -0,0 +1,20 @@
+#pragma once
+
+#include "util.h"
+
+struct StreamPos {
+  signed char filename;
+  short line = -1;
+  signed char column;
+};
+
+using StreamPosStack = std::array<StreamPos, 4>;
+
+// Config text after comment removal and macro expansion, ready to be parsed by PrettyInputArchive. Positions for
+// error messages are kept per character in a side table. Producing it doesn't touch any global state, so independent
+// files can be preprocessed concurrently.
+struct PrettyInput {
+  string text;
+  vector<StreamPosStack> positions;
+  vector<string> filenames;
+};
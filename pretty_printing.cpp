@@ -72,9 +72,40 @@ optional<string> PrettyPrinting::parseObject(T& object, const vector<string>& s,
   }
 }
 
+template <typename T>
+optional<string> PrettyPrinting::parseObject(T& object, PrettyInput preprocessed, KeyVerifier* keyVerifier) {
+  try {
+    PrettyInputArchive input(std::move(preprocessed), keyVerifier);
+    input(object);
+    return none;
+  } catch (PrettyException ex) {
+    return ex.text;
+  }
+}
+
+optional<string> PrettyPrinting::preprocess(const vector<FilePath>& paths, PrettyInput& result) {
+  vector<string> allContent;
+  vector<string> pathStrings;
+  for (auto& path : paths) {
+    pathStrings.push_back(path.getPath());
+    if (auto contents = path.readContents())
+      allContent.push_back(std::move(*contents));
+    else
+      return "Couldn't open file: "_s + path.getPath();
+  }
+  try {
+    result = PrettyInputArchive::preprocessInput(allContent, pathStrings);
+    return none;
+  } catch (PrettyException ex) {
+    return ex.text;
+  }
+}
+
 #define ADD_IMP(...) \
 template \
-optional<string> PrettyPrinting::parseObject<__VA_ARGS__>(__VA_ARGS__&, const vector<string>&, vector<string>, KeyVerifier*);
+optional<string> PrettyPrinting::parseObject<__VA_ARGS__>(__VA_ARGS__&, const vector<string>&, vector<string>, KeyVerifier*);\
+template \
+optional<string> PrettyPrinting::parseObject<__VA_ARGS__>(__VA_ARGS__&, PrettyInput, KeyVerifier*);
 
 ADD_IMP(Effect)
 ADD_IMP(ItemType)
@@ -3,6 +3,7 @@
 #include "stdafx.h"
 #include "util.h"
 #include "file_path.h"
+#include "pretty_input.h"
 
 class Effect;
 class ItemType;
@@ -18,17 +19,17 @@ class PrettyPrinting {
     return parseObject(object, vector<string>(1, text));
   }
 
+  template<typename T>
+  static optional<string> parseObject(T& object, PrettyInput, KeyVerifier* keyVerifier);
+
   template<typename T>
   static optional<string> parseObject(T& object, vector<FilePath> paths, KeyVerifier* keyVerifier) {
-    vector<string> allContent;
-    vector<string> pathStrings;
-    for (auto& path : paths) {
-      pathStrings.push_back(path.getPath());
-      if (auto contents = path.readContents())
-        allContent.push_back(*contents);
-      else
-        return "Couldn't open file: "_s + path.getPath();
-    }
-    return PrettyPrinting::parseObject<T>(object, allContent, pathStrings, keyVerifier);
+    PrettyInput input;
+    if (auto error = preprocess(paths, input))
+      return error;
+    return PrettyPrinting::parseObject<T>(object, std::move(input), keyVerifier);
   }
+
+  // Reads the files and expands macros, without touching any global state. Returns an error message on failure.
+  static optional<string> preprocess(const vector<FilePath>& paths, PrettyInput& result);
 };
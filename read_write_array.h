@@ -9,86 +9,154 @@ class ReadWriteArray {
   typedef unique_ptr<Type> PType;
   typedef Type* WType;
 
-  ReadWriteArray(Rectangle bounds) : modified(bounds, -1), readonly(bounds, -1), types(bounds) {}
+  // Elements that haven't been modified since they were generated from a Param. Arrays of all levels in a model
+  // share one instance, so each Param is generated once per model.
+  class Prototypes {
+    public:
+    template <typename Generator>
+    int getIndex(const Param& param, const Generator& generator) {
+      if (auto index = getValueMaybe(indexes, param))
+        return *index;
+      elems.push_back(generator(param));
+      CHECK(elems.size() < 30000);
+      indexes.insert(make_pair(param, elems.size() - 1));
+      return elems.size() - 1;
+    }
+
+    int add(const Param& param, PType elem) {
+      if (auto index = getValueMaybe(indexes, param))
+        return *index;
+      elems.push_back(std::move(elem));
+      indexes.insert(make_pair(param, elems.size() - 1));
+      return elems.size() - 1;
+    }
+
+    const WType get(int index) const {
+      return elems[index].get();
+    }
+
+    int getSize() const {
+      return elems.size();
+    }
+
+    long long getMemoryUsage() const {
+      return elems.size() * (sizeof(PType) + sizeof(Type) + sizeof(Param) + sizeof(int));
+    }
+
+    SERIALIZE_ALL(elems, indexes)
+
+    private:
+    friend class ReadWriteArray;
+    vector<PType> SERIAL(elems);
+    HashMap<Param, int> SERIAL(indexes);
+  };
+
+  ReadWriteArray(Rectangle bounds) : elems(bounds, -1), prototypes(make_shared<Prototypes>()) {}
 
   const Rectangle& getBounds() const {
-    return modified.getBounds();
+    return elems.getBounds();
   }
 
   void clearModified() {
-    unordered_set<int> used;
-    for (auto v : modified.getBounds())
-      used.insert(modified[v]);
+    vector<char> used(allModified.size(), false);
+    for (auto v : elems.getBounds())
+      if (isModified(elems[v]))
+        used[getModifiedIndex(elems[v])] = true;
     for (int i : All(allModified))
-      if (!used.count(i))
+      if (!used[i])
         allModified[i].reset();
   }
 
   WType getWritable(Vec2 pos) {
-    if (modified[pos] == -1)
-      if (auto type = types[pos])
-        putElem(pos, make_unique<Type>(*getReadonly(pos)));
-    if (modified[pos] > -1)
-      return allModified[modified[pos]].get();
-    else
+    auto index = elems[pos];
+    if (index == -1)
       return nullptr;
+    if (!isModified(index))
+      putElem(pos, make_unique<Type>(*prototypes->get(index)));
+    return allModified[getModifiedIndex(elems[pos])].get();
   }
 
   const WType getReadonly(Vec2 pos) const {
-    if (readonly[pos] > -1)
-      return allReadonly[readonly[pos]].get();
-    else if (modified[pos] > -1)
-      return allModified[modified[pos]].get();
-    else
+    auto index = elems[pos];
+    if (index == -1)
       return nullptr;
+    else if (isModified(index))
+      return allModified[getModifiedIndex(index)].get();
+    else
+      return prototypes->get(index);
   }
 
   template <typename Generator>
   void putElem(Vec2 pos, Param param, const Generator& generator) {
-    if (!readonlyMap.count(param)) {
-      allReadonly.push_back(generator(param));
-      CHECK(allReadonly.size() < 30000);
-      readonlyMap.insert(make_pair(param, allReadonly.size() - 1));
-    }
-    readonly[pos] = readonlyMap.at(param);
-    modified[pos] = -1;
-    types[pos] = param;
+    elems[pos] = prototypes->getIndex(param, generator);
   }
 
   void putElem(Vec2 pos, PType s) {
     allModified.push_back(std::move(s));
-    modified[pos] = allModified.size() - 1;
-    readonly[pos] = -1;
+    elems[pos] = getModifiedValue(allModified.size() - 1);
   }
 
   void clearElem(Vec2 pos) {
-    types[pos] = none;
-    modified[pos] = -1;
-    readonly[pos] = -1;
+    elems[pos] = -1;
+  }
+
+  // Moves the unmodified elements to the given shared prototypes, dropping the ones that it already has.
+  void sharePrototypes(const ReadWriteArray& other) {
+    if (other.prototypes == prototypes)
+      return;
+    vector<int> remap(prototypes->elems.size(), -1);
+    for (auto& elem : prototypes->indexes)
+      remap[elem.second] = other.prototypes->add(elem.first, std::move(prototypes->elems[elem.second]));
+    for (auto v : elems.getBounds())
+      if (elems[v] > -1)
+        elems[v] = remap[elems[v]];
+    prototypes = other.prototypes;
+  }
+
+  const Prototypes& getPrototypes() const {
+    return *prototypes;
   }
 
   int getNumGenerated() const {
-    return allModified.size() + readonlyMap.size();
+    return allModified.size() + prototypes->getSize();
   }
 
   int getNumTotal() const {
     return 0;
   }
 
+  int getNumModified() const {
+    return allModified.size();
+  }
+
+  // Excludes the shared prototypes.
+  long long getMemoryUsage() const {
+    return elems.getBounds().area() * sizeof(int) +
+        allModified.capacity() * sizeof(PType) + allModified.size() * sizeof(Type);
+  }
+
   void shrinkToFit() {
     allModified.shrink_to_fit();
-    allReadonly.shrink_to_fit();
   }
 
-  SERIALIZE_ALL(allModified, modified, allReadonly, readonly, types, readonlyMap, numTotal)
+  SERIALIZE_ALL(allModified, elems, prototypes)
   SERIALIZATION_CONSTRUCTOR(ReadWriteArray)
 
   private:
+  // Values of elems: -1 is empty, non-negative values index the prototypes and values below -1 index allModified.
+  static bool isModified(int value) {
+    return value < -1;
+  }
+
+  static int getModifiedIndex(int value) {
+    return -2 - value;
+  }
+
+  static int getModifiedValue(int index) {
+    return -2 - index;
+  }
+
   vector<PType> SERIAL(allModified);
-  Table<int> SERIAL(modified);
-  vector<PType> SERIAL(allReadonly);
-  Table<short> SERIAL(readonly);
-  Table<optional<Param>> SERIAL(types);
-  HashMap<Param, short> SERIAL(readonlyMap);
-  int SERIAL(numTotal) = 0;
+  Table<int> SERIAL(elems);
+  shared_ptr<Prototypes> SERIAL(prototypes);
 };
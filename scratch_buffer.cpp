@@ -0,0 +1,64 @@
+#include "stdafx.h"
+#include "scratch_buffer.h"
+
+static constexpr size_t chunkSize = 1 << 20;
+
+// Chunks change hands rarely, so the pool takes a lock. The counters are only for benchmarks and aren't synchronized.
+static vector<unique_ptr<char[]>> chunkPool;
+static std::mutex chunkPoolMutex;
+static ScratchBuffer::Stats stats;
+
+static unique_ptr<char[]> popPooledChunk() {
+  std::unique_lock<std::mutex> lock(chunkPoolMutex);
+  if (chunkPool.empty())
+    return nullptr;
+  auto ret = std::move(chunkPool.back());
+  chunkPool.pop_back();
+  return ret;
+}
+
+const ScratchBuffer::Stats& ScratchBuffer::getStats() {
+  return stats;
+}
+
+void ScratchBuffer::resetStats() {
+  stats = Stats{};
+}
+
+ScratchBuffer::~ScratchBuffer() {
+  reset();
+}
+
+char* ScratchBuffer::allocateBytes(size_t size, size_t alignment) {
+  ++stats.numAllocations;
+  stats.numBytes += size;
+  if (!chunks.empty()) {
+    size_t offset = (used + alignment - 1) / alignment * alignment;
+    if (offset + size <= chunks.back().size) {
+      used = offset + size;
+      return chunks.back().mem.get() + offset;
+    }
+  }
+  if (size <= chunkSize) {
+    if (auto pooled = popPooledChunk())
+      chunks.push_back(Chunk{std::move(pooled), chunkSize});
+    else {
+      chunks.push_back(Chunk{unique_ptr<char[]>(new char[chunkSize]), chunkSize});
+      ++stats.numNewChunks;
+    }
+  } else {
+    chunks.push_back(Chunk{unique_ptr<char[]>(new char[size]), size});
+    ++stats.numNewChunks;
+  }
+  used = size;
+  return chunks.back().mem.get();
+}
+
+void ScratchBuffer::reset() {
+  std::unique_lock<std::mutex> lock(chunkPoolMutex);
+  for (auto& chunk : chunks)
+    if (chunk.size == chunkSize)
+      chunkPool.push_back(std::move(chunk.mem));
+  chunks.clear();
+  used = 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "util.h"
+
+// Table view over memory owned by a ScratchBuffer. Indexed like Table.
+template <typename T>
+class ScratchTable {
+  public:
+  ScratchTable(Rectangle bounds, T* mem) : bounds(bounds), mem(mem) {}
+
+  const Rectangle& getBounds() const {
+    return bounds;
+  }
+
+  T& operator[](const Vec2& vAbs) {
+    CHECK(vAbs.inRectangle(bounds)) << "Table index out of bounds " << bounds << " " << vAbs;
+    return mem[(vAbs.x - bounds.left()) * bounds.height() + vAbs.y - bounds.top()];
+  }
+
+  const T& operator[](const Vec2& vAbs) const {
+    CHECK(vAbs.inRectangle(bounds)) << "Table index out of bounds " << bounds << " " << vAbs;
+    return mem[(vAbs.x - bounds.left()) * bounds.height() + vAbs.y - bounds.top()];
+  }
+
+  private:
+  Rectangle bounds;
+  T* mem;
+};
+
+// Bump allocator for temporaries of level generation. Memory handed out stays valid until reset(), which returns the
+// chunks to a shared pool, so the next level reuses them instead of going through the heap again.
+class ScratchBuffer {
+  public:
+  ScratchBuffer() {}
+  ScratchBuffer(const ScratchBuffer&) = delete;
+  ScratchBuffer(ScratchBuffer&&) = default;
+  ScratchBuffer& operator = (ScratchBuffer&&) = default;
+  ~ScratchBuffer();
+
+  template <typename T>
+  T* allocate(int count) {
+    static_assert(std::is_trivially_destructible<T>::value, "Scratch memory is never destructed");
+    return reinterpret_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+  }
+
+  template <typename T>
+  ScratchTable<T> getTable(Rectangle bounds, const T& value) {
+    auto mem = allocate<T>(bounds.area());
+    std::fill(mem, mem + bounds.area(), value);
+    return ScratchTable<T>(bounds, mem);
+  }
+
+  void reset();
+
+  struct Stats {
+    long long numAllocations = 0;
+    long long numBytes = 0;
+    // Chunks that had to be taken from the heap because the pool was empty.
+    long long numNewChunks = 0;
+  };
+  // Counted over all buffers since the last call to resetStats.
+  static const Stats& getStats();
+  static void resetStats();
+
+  private:
+  char* allocateBytes(size_t size, size_t alignment);
+  struct Chunk {
+    unique_ptr<char[]> mem;
+    size_t size;
+  };
+  vector<Chunk> chunks;
+  size_t used = 0;
+};
@@ -0,0 +1,140 @@
+#include "stdafx.h"
+#include "slab_allocator.h"
+#include "debug.h"
+#include "util.h"
+
+static size_t getAlignedSize(size_t size) {
+  constexpr size_t alignment = alignof(std::max_align_t);
+  return (max(size, sizeof(void*)) + alignment - 1) / alignment * alignment;
+}
+
+SlabAllocator::SlabAllocator(size_t size, int num) : blockSize(getAlignedSize(size)), blocksPerSlab(num) {
+  CHECK(blocksPerSlab > 0);
+}
+
+SlabAllocator::~SlabAllocator() {
+}
+
+unique_ptr<SlabAllocator::Slab> SlabAllocator::makeSlab() const {
+  auto ret = make_unique<Slab>();
+  ret->memory.reset(new char[blockSize * blocksPerSlab]);
+  // Thread the blocks in address order, so consecutive allocations are adjacent.
+  for (int i = blocksPerSlab - 1; i >= 0; --i) {
+    auto block = reinterpret_cast<FreeBlock*>(ret->memory.get() + i * blockSize);
+    block->next = ret->freeList;
+    ret->freeList = block;
+  }
+  return ret;
+}
+
+void* SlabAllocator::allocate(size_t size) {
+  if (getAlignedSize(size) != blockSize)
+    return ::operator new(size);
+  if (available.empty()) {
+    auto slab = emptySlab ? std::move(emptySlab) : makeSlab();
+    slab->available = true;
+    available.push_back(slab.get());
+    auto lastByte = slab->memory.get() + blockSize * blocksPerSlab - 1;
+    slabs[lastByte] = std::move(slab);
+  }
+  auto slab = available.back();
+  auto ret = slab->freeList;
+  slab->freeList = ret->next;
+  ++slab->numAllocated;
+  ++numAllocated;
+  if (!slab->freeList) {
+    slab->available = false;
+    available.pop_back();
+  }
+  return ret;
+}
+
+void SlabAllocator::deallocate(void* ptr, size_t size) {
+  if (!ptr)
+    return;
+  if (getAlignedSize(size) != blockSize) {
+    ::operator delete(ptr);
+    return;
+  }
+  auto it = slabs.lower_bound(static_cast<const char*>(ptr));
+  CHECK(it != slabs.end() && static_cast<const char*>(ptr) >= it->second->memory.get());
+  auto slab = it->second.get();
+  auto block = static_cast<FreeBlock*>(ptr);
+  block->next = slab->freeList;
+  slab->freeList = block;
+  --slab->numAllocated;
+  --numAllocated;
+  if (slab->numAllocated == 0) {
+    if (slab->available)
+      available.removeElement(slab);
+    slab->available = false;
+    if (!emptySlab)
+      emptySlab = std::move(it->second);
+    slabs.erase(it);
+  } else if (!slab->available) {
+    slab->available = true;
+    available.push_back(slab);
+  }
+}
+
+int SlabAllocator::getNumAllocated() const {
+  return numAllocated;
+}
+
+int SlabAllocator::getNumSlabs() const {
+  return slabs.size();
+}
+
+void benchmarkSlabAllocator(const string& name, size_t blockSize, int numBlocks) {
+  using namespace std::chrono;
+  SlabAllocator slabs(blockSize);
+  auto run = [&](function<void*()> allocate, function<void(void*)> deallocate) {
+    RandomGen random;
+    random.init(1234);
+    // Other objects are allocated in between, as they would be when generating a model.
+    vector<char*> noise;
+    vector<char*> blocks;
+    auto time = steady_clock::now();
+    vector<double> ret;
+    auto lap = [&] {
+      auto now = steady_clock::now();
+      ret.push_back(double(duration_cast<microseconds>(now - time).count()) / 1000);
+      time = now;
+    };
+    for (int i : Range(numBlocks)) {
+      blocks.push_back(static_cast<char*>(allocate()));
+      memset(blocks.back(), 0, blockSize);
+      noise.push_back(new char[random.get(16, 512)]);
+    }
+    lap();
+    long long sum = 0;
+    for (int pass : Range(10))
+      for (auto block : blocks) {
+        // Reads a few fields spread over the object, like a tick would.
+        for (int offset = 0; offset < blockSize; offset += 64)
+          sum += block[offset];
+        ++block[0];
+      }
+    lap();
+    for (int i : Range(numBlocks / 2)) {
+      int index = random.get(numBlocks);
+      deallocate(blocks[index]);
+      blocks[index] = static_cast<char*>(allocate());
+      blocks[index][0] = 0;
+    }
+    lap();
+    for (auto block : blocks)
+      deallocate(block);
+    lap();
+    for (auto elem : noise)
+      delete[] elem;
+    CHECK(sum >= 0);
+    return ret;
+  };
+  auto slabTimes = run([&] { return slabs.allocate(blockSize); }, [&](void* p) { slabs.deallocate(p, blockSize); });
+  auto heapTimes = run([&] { return ::operator new(blockSize); }, [&](void* p) { ::operator delete(p); });
+  const char* phases[] = {"allocate", "traverse x10", "churn", "free"};
+  std::cout << name << " (" << blockSize << " bytes), " << numBlocks << " objects:" << std::endl;
+  for (int i : All(slabTimes))
+    std::cout << "  " << phases[i] << ": slabs " << slabTimes[i] << " ms, heap " << heapTimes[i] << " ms" << std::endl;
+}
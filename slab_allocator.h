@@ -0,0 +1,66 @@
+#pragma once
+
+#include "stdafx.h"
+#include "my_containers.h"
+
+/** Hands out fixed size blocks carved from large contiguous slabs, so that objects of one type that are iterated
+    together stay close in memory. A slab is released once all of its blocks are returned, except for one empty slab
+    that is kept to avoid reallocating it back and forth. Requests of a different size (e.g. subclasses) go to the
+    global allocator. Not thread safe, objects are only created and destroyed by the thread that owns the game or
+    generates the models.*/
+class SlabAllocator {
+  public:
+  SlabAllocator(size_t blockSize, int blocksPerSlab = 256);
+  ~SlabAllocator();
+  void* allocate(size_t size);
+  void deallocate(void*, size_t size);
+  int getNumAllocated() const;
+  // Slabs holding at least one allocated block.
+  int getNumSlabs() const;
+
+  private:
+  const size_t blockSize;
+  const int blocksPerSlab;
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+  struct Slab {
+    unique_ptr<char[]> memory;
+    FreeBlock* freeList = nullptr;
+    int numAllocated = 0;
+    bool available = false;
+  };
+  unique_ptr<Slab> makeSlab() const;
+  // Keyed by the address of the last byte, so lower_bound finds the slab holding a block.
+  std::map<const char*, unique_ptr<Slab>> slabs;
+  // Slabs with free blocks. The last one is allocated from first.
+  vector<Slab*> available;
+  unique_ptr<Slab> emptySlab;
+  int numAllocated = 0;
+};
+
+// Times allocation, traversal and teardown of blocks of the given size from slabs and from the global heap.
+void benchmarkSlabAllocator(const string& name, size_t blockSize, int numBlocks);
+
+/** Routes allocations of the class through a SlabAllocator. makeOwner() uses plain new for such classes,
+    as make_shared would bypass the class operator new. Needs SLAB_ALLOCATED_IMPL in the .cpp file.*/
+#define SLAB_ALLOCATED(T) \
+  using SlabAllocatedTag = T; \
+  static void* operator new(size_t); \
+  static void operator delete(void*, size_t); \
+  static const SlabAllocator& getSlabAllocator();
+
+#define SLAB_ALLOCATED_IMPL(T) \
+  static SlabAllocator& get##T##Slabs() { \
+    static SlabAllocator* ret = new SlabAllocator(sizeof(T)); \
+    return *ret; \
+  } \
+  void* T::operator new(size_t size) { \
+    return get##T##Slabs().allocate(size); \
+  } \
+  void T::operator delete(void* ptr, size_t size) { \
+    get##T##Slabs().deallocate(ptr, size); \
+  } \
+  const SlabAllocator& T::getSlabAllocator() { \
+    return get##T##Slabs(); \
+  }
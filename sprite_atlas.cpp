@@ -0,0 +1,107 @@
+#include "stdafx.h"
+#include "sprite_atlas.h"
+#include "extern/lodepng.h"
+
+SERIALIZE_DEF(SpriteAtlas, key, tileSize, width, numFrames, sprites, pixels)
+
+SERIALIZATION_CONSTRUCTOR_IMPL(SpriteAtlas)
+
+size_t SpriteAtlas::getKey(const vector<FilePath>& images, Vec2 tileSize, int width) {
+  size_t ret = combineHash(tileSize.x, tileSize.y, width);
+  for (auto& image : images)
+    ret = combineHash(ret, string(image.getFileName()), (long long) image.getModificationTime());
+  return ret;
+}
+
+const vector<SpriteAtlas::Sprite>& SpriteAtlas::getSprites() const {
+  return sprites;
+}
+
+int SpriteAtlas::getNumFrames() const {
+  return numFrames;
+}
+
+Vec2 SpriteAtlas::getSize() const {
+  int rowLength = width / tileSize.x;
+  return Vec2(width, (numFrames / rowLength + 1) * tileSize.y);
+}
+
+const unsigned char* SpriteAtlas::getPixels() const {
+  return pixels.data();
+}
+
+void SpriteAtlas::addImage(const string& name, const std::vector<unsigned char>& image, int imageWidth) {
+  int rowLength = width / tileSize.x;
+  int frames = imageWidth / tileSize.x;
+  pixels.resize(width * 4 * ((numFrames + frames) / rowLength + 1) * tileSize.y);
+  for (int frame : Range(frames)) {
+    Vec2 dest(tileSize.x * (numFrames % rowLength), tileSize.y * (numFrames / rowLength));
+    for (int y : Range(tileSize.y))
+      memcpy(&pixels[((dest.y + y) * width + dest.x) * 4],
+          &image[(y * imageWidth + frame * tileSize.x) * 4], tileSize.x * 4);
+    ++numFrames;
+  }
+  sprites.push_back(Sprite{name, frames});
+}
+
+SpriteAtlas SpriteAtlas::loadOrBuild(const vector<FilePath>& images, Vec2 tileSize, int width,
+    const FilePath& cachePath) {
+  auto key = getKey(images, tileSize, width);
+  if (cachePath.exists()) {
+    SpriteAtlas cached;
+    try {
+      ifstream in(cachePath.getPath(), std::ios::binary);
+      InputArchive ar1(in);
+      ar1(cached);
+      if (cached.key == key) {
+        INFO << "Loaded sprite atlas from " << cachePath;
+        return cached;
+      }
+    } catch (std::exception&) {
+      INFO << "Failed to read sprite atlas cache " << cachePath;
+    }
+  }
+  struct Decoded {
+    std::vector<unsigned char> pixels;
+    unsigned width = 0;
+    unsigned height = 0;
+    unsigned error = 0;
+  };
+  vector<Decoded> decoded(images.size());
+  atomic<int> nextImage(0);
+  auto decodeImages = [&] {
+    for (int i = nextImage++; i < images.size(); i = nextImage++) {
+      auto& image = decoded[i];
+      image.error = lodepng::decode(image.pixels, image.width, image.height, images[i].getPath());
+    }
+  };
+  vector<std::thread> threads;
+  for (int i : Range(max<int>(1, std::thread::hardware_concurrency()) - 1))
+    threads.push_back(std::thread(decodeImages));
+  decodeImages();
+  for (auto& t : threads)
+    t.join();
+  SpriteAtlas ret;
+  ret.key = key;
+  ret.tileSize = tileSize;
+  ret.width = width;
+  const static string imageSuf = ".png";
+  for (int i : All(images)) {
+    auto& image = decoded[i];
+    if (image.error) {
+      USER_INFO << "Error loading image " << images[i].getPath() << ": " << lodepng_error_text(image.error);
+      continue;
+    }
+    USER_CHECK((image.width % tileSize.x == 0) && image.height == tileSize.y) << images[i] << " has wrong size "
+        << image.width << " " << image.height;
+    string fileName = images[i].getFileName();
+    ret.addImage(fileName.substr(0, fileName.size() - imageSuf.size()), image.pixels, image.width);
+  }
+  ret.pixels.resize(ret.getSize().x * ret.getSize().y * 4);
+  ofstream out(cachePath.getPath(), std::ios::binary);
+  if (out.good()) {
+    OutputArchive ar1(out);
+    ar1(ret);
+  }
+  return ret;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "util.h"
+#include "file_path.h"
+
+// Sprites of one tile size packed into a single RGBA image. Frames go left to right in rows of width / tileSize.x,
+// in the order of the sprites list.
+class SpriteAtlas {
+  public:
+  // Decodes the images in parallel, or reads the whole atlas from cachePath if it was built from the same files.
+  static SpriteAtlas loadOrBuild(const vector<FilePath>& images, Vec2 tileSize, int width, const FilePath& cachePath);
+
+  struct Sprite {
+    string SERIAL(name);
+    int SERIAL(numFrames);
+    SERIALIZE_ALL(name, numFrames)
+  };
+
+  const vector<Sprite>& getSprites() const;
+  int getNumFrames() const;
+  Vec2 getSize() const;
+  // Rows of width * 4 bytes, RGBA.
+  const unsigned char* getPixels() const;
+
+  SERIALIZATION_DECL(SpriteAtlas)
+
+  private:
+  static size_t getKey(const vector<FilePath>& images, Vec2 tileSize, int width);
+  void addImage(const string& name, const std::vector<unsigned char>& pixels, int imageWidth);
+  size_t SERIAL(key) = 0;
+  Vec2 SERIAL(tileSize);
+  int SERIAL(width) = 0;
+  int SERIAL(numFrames) = 0;
+  vector<Sprite> SERIAL(sprites);
+  std::vector<unsigned char> SERIAL(pixels);
+};
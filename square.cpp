@@ -25,7 +25,6 @@
 #include "vision.h"
 #include "view_index.h"
 #include "inventory.h"
-#include "tile_gas.h"
 #include "tribe.h"
 #include "view.h"
 #include "game_event.h"
@@ -33,12 +32,11 @@
 #include "lasting_effect.h"
 #include "furniture.h"
 #include "content_factory.h"
-#include "tile_gas_info.h"
 
 template <class Archive> 
 void Square::serialize(Archive& ar, const unsigned int version) { 
   ar(inventory, onFire);
-  ar(creature, landingLink, tileGas);
+  ar(creature, landingLink);
   ar(lastViewer, viewIndex);
   ar(forbiddenTribe);
   if (progressMeter)
@@ -96,7 +94,6 @@ void Square::tick(Position pos) {
           break;
         }
   }
-  tileGas->tick(pos);
 }
 
 bool Square::itemLands(vector<Item*> item, const Attack& attack) const {
@@ -126,26 +123,6 @@ void Square::onItemLands(Position pos, vector<PItem> item, const Attack& attack)
     pos.dropItems(std::move(item));
 }
 
-void Square::addGas(Position pos, TileGasType type, double amount) {
-  setDirty(pos);
-  if (pos.canSeeThruIgnoringGas(VisionId::NORMAL)) {
-    tileGas->addAmount(pos, type, amount);
-    pos.getLevel()->addTickingSquare(pos.getCoord());
-  }
-}
-
-void Square::addPermanentGas(TileGasType type, double amount) {
-  tileGas->addPermanentAmount(type, amount);
-}
-
-double Square::getGasAmount(TileGasType type) const {
-  return tileGas->getAmount(type);
-}
-
-bool Square::hasSunlightBlockingGasAmount() const {
-  return tileGas->hasSunlightBlockingAmount();
-}
-
 void Square::getViewIndex(const ContentFactory* factory, ViewIndex& ret, const Creature* viewer) const {
   if ((!viewer && lastViewer) || (viewer && lastViewer == viewer->getUniqueId())) {
     ret = *viewIndex;
@@ -163,12 +140,6 @@ void Square::getViewIndex(const ContentFactory* factory, ViewIndex& ret, const C
       }
     ret.insert(std::move(obj));
   }
-  CHECK(ret.getGasAmounts().empty());
-  for (auto& type : factory->tileGasTypes) {
-    auto amount = tileGas->getAmount(type.first);
-    if (amount > 0)
-      ret.addGasAmount(type.second.name, type.second.color.transparency(amount * 255));
-  }
   *viewIndex = ret;
 }
 
@@ -23,7 +23,6 @@
 class Creature;
 class Item;
 class ProgressMeter;
-class TileGas;
 class Inventory;
 class Position;
 class ViewIndex;
@@ -45,11 +44,6 @@ class Square {
   /** Returns the entry point details. Returns none if square is not entry point. See setLandingLink().*/
   optional<StairKey> getLandingLink() const;
 
-  void addGas(Position, TileGasType, double amount);
-  void addPermanentGas(TileGasType, double amount);
-  double getGasAmount(TileGasType) const;
-  bool hasSunlightBlockingGasAmount() const;
-
   /** Sets the level this square is on.*/
   void onAddedToLevel(Position) const;
 
@@ -105,7 +99,6 @@ class Square {
   HeapAllocated<Inventory> SERIAL(inventory);
   Creature* SERIAL(creature) = nullptr;
   optional<StairKey> SERIAL(landingLink);
-  HeapAllocated<TileGas> SERIAL(tileGas);
   mutable optional<UniqueEntity<Creature>::Id> SERIAL(lastViewer);
   unique_ptr<ViewIndex> SERIAL(viewIndex);
   optional<TribeId> SERIAL(forbiddenTribe);
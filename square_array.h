@@ -42,4 +42,9 @@ class SquareArray {
     return numModified;
   }
 
+  // Approximate number of bytes.
+  long long getMemoryUsage() const {
+    return getBounds().area() * sizeof(PSquare) + (numModified + 1) * sizeof(Square);
+  }
+
 };
@@ -2,7 +2,7 @@
 #include "stair_key.h"
 
 StairKey StairKey::getNew() {
-  return Random.getLL();
+  return IdRandom.getLL();
 }
 
 StairKey StairKey::keeperSpawn() {
@@ -1,14 +1,18 @@
 #include "storage_positions.h"
 
 void StoragePositions::add(Position p) {
-  ++positions[p];
+  if (!positions.insert(p))
+    ++extraCount[p];
 }
 
 void StoragePositions::remove(Position p) {
-  auto res = --positions[p];
-  CHECK(res >= 0);
-  if (res == 0)
-    positions.erase(p);
+  if (auto count = getReferenceMaybe(extraCount, p)) {
+    if (--*count == 0)
+      extraCount.erase(p);
+  } else {
+    auto res = positions.erase(p);
+    CHECK(res == 1);
+  }
 }
 
 bool StoragePositions::empty() const {
@@ -20,13 +24,13 @@ bool StoragePositions::contains(Position p) const {
 }
 
 vector<Position> StoragePositions::asVector() const {
-  return getKeys(positions);
+  return positions.asVector();
 }
 
-SERIALIZE_DEF(StoragePositions, positions)
+SERIALIZE_DEF(StoragePositions, positions, extraCount)
 
 const Position& StoragePositions::Iter::operator* () const {
-  return iter->first;
+  return *iter;
 }
 
 bool StoragePositions::Iter::operator != (const Iter& other) const {
@@ -6,8 +6,6 @@
 class StoragePositions {
   public:
 
-  using MapType = HashMap<Position, int>;
-
   void add(Position);
   void remove(Position);
   bool empty() const;
@@ -18,7 +16,7 @@ class StoragePositions {
   void serialize(Archive&, unsigned int);
 
   struct Iter {
-    MapType::const_iterator iter;
+    PositionSet::const_iterator iter;
 
     const Position& operator* () const;
     bool operator != (const Iter& other) const;
@@ -29,7 +27,9 @@ class StoragePositions {
   Iter end() const;
 
   private:
-  MapType SERIAL(positions);
+  PositionSet SERIAL(positions);
+  // The same position can be added more than once, which is rare, so only the extra counts are kept here.
+  HashMap<Position, int> SERIAL(extraCount);
 };
 
 
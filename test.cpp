@@ -48,6 +48,11 @@
 #include "biome_id.h"
 #include "item_types.h"
 #include "creature_attributes.h"
+#include "perlin_noise.h"
+#include "tile_sampler.h"
+#include "move_cache.h"
+#include "slab_allocator.h"
+#include "melee_batch.h"
 
 class Test {
   public:
@@ -1293,6 +1298,191 @@ class Test {
       ret += x;
     CHECK(ret == 0);
   }
+
+  // Straightforward diamond-square, kept to check that genNoiseMap produces the same terrain.
+  static Table<double> genNoiseMapReference(RandomGen& random, Rectangle area, NoiseInit init, double varianceMult) {
+    int width = 1;
+    while (width < area.width() - 1 || width < area.height() - 1)
+      width *= 2;
+    width /= 2;
+    ++width;
+    Table<double> wys(width, width);
+    wys[0][0] = init.topLeft;
+    wys[width - 1][0] = init.topRight;
+    wys[width - 1][width - 1] = init.bottomRight;
+    wys[0][width - 1] = init.bottomLeft;
+    wys[(width - 1) / 2][(width - 1) / 2] = init.middle;
+    auto addAvg = [&](int x, int y, double& avg, int& num) {
+      if (Vec2(x, y).inRectangle(wys.getBounds())) {
+        avg += wys[x][y];
+        ++num;
+      }
+    };
+    double variance = 0.5;
+    for (int a = width - 1; a >= 2; a /= 2) {
+      if (a < width - 1)
+        for (Vec2 pos1 : Rectangle((width - 1) / a, (width - 1) / a)) {
+          Vec2 pos = pos1 * a;
+          double avg = (wys[pos] + wys[pos.x + a][pos.y] + wys[pos.x][pos.y + a] + wys[pos.x + a][pos.y + a]) / 4;
+          wys[pos.x + a / 2][pos.y + a / 2] = avg + variance * (random.getDouble() * 2 - 1);
+        }
+      for (Vec2 pos1 : Rectangle((width - 1) / a, (width - 1) / a + 1)) {
+        Vec2 pos = pos1 * a;
+        double avg = 0;
+        int num = 0;
+        addAvg(pos.x + a / 2, pos.y - a / 2, avg, num);
+        addAvg(pos.x, pos.y, avg, num);
+        addAvg(pos.x + a, pos.y, avg, num);
+        addAvg(pos.x + a / 2, pos.y + a / 2, avg, num);
+        wys[pos.x + a / 2][pos.y] = avg / num + variance * (random.getDouble() * 2 - 1);
+      }
+      for (Vec2 pos1 : Rectangle((width - 1) / a + 1, (width - 1) / a)) {
+        Vec2 pos = pos1 * a;
+        double avg = 0;
+        int num = 0;
+        addAvg(pos.x - a / 2, pos.y + a / 2, avg, num);
+        addAvg(pos.x, pos.y, avg, num);
+        addAvg(pos.x, pos.y + a, avg, num);
+        addAvg(pos.x + a / 2, pos.y + a / 2, avg, num);
+        wys[pos.x][pos.y + a / 2] = avg / num + variance * (random.getDouble() * 2 - 1);
+      }
+      variance *= varianceMult;
+    }
+    Table<double> ret(area);
+    for (Vec2 v : area)
+      ret[v] = wys[(v.x - area.left()) * width / area.width()][(v.y - area.top()) * width / area.height()];
+    return ret;
+  }
+
+  void testNoiseMap() {
+    for (auto area : {Rectangle(1, 1), Rectangle(5, 3, 37, 20), Rectangle(100, 100), Rectangle(360, 270)})
+      for (int seed : Range(3)) {
+        RandomGen r1, r2;
+        r1.init(seed);
+        r2.init(seed);
+        auto map = genNoiseMap(r1, area, NoiseInit{0, 1, 0, 0, 0}, 0.45);
+        auto reference = genNoiseMapReference(r2, area, NoiseInit{0, 1, 0, 0, 0}, 0.45);
+        for (Vec2 v : area)
+          CHECK(map[v] == reference[v]) << area << " " << seed << " " << v;
+        CHECK(r1.get(1000000) == r2.get(1000000));
+      }
+  }
+
+  void testSortedValues() {
+    RandomGen r;
+    r.init(7);
+    auto map = genNoiseMap(r, Rectangle(50, 40), NoiseInit{1, 1, 1, 1, 1}, 0.65);
+    vector<double> all;
+    for (Vec2 v : map.getBounds())
+      all.push_back(map[v]);
+    sort(all.begin(), all.end());
+    vector<int> indices {1999, 0, 700, 700, 1500, 3};
+    auto values = getSortedValues(map, indices);
+    for (int i : All(indices))
+      CHECK(values[i] == all[indices[i]]) << indices[i];
+  }
+
+  void testTileSampler() {
+    RandomGen r;
+    r.init(3);
+    TileSampler sampler(Rectangle(-5, -5, 5, 5));
+    for (Vec2 v : Rectangle(-5, -5, 5, 5))
+      if ((v.x + v.y) % 3 == 0)
+        sampler.insert(v);
+    sampler.insert(Vec2(0, 0));
+    sampler.erase(Vec2(3, 0));
+    sampler.erase(Vec2(4, 4));
+    CHECK(sampler.getSize() == 32);
+    CHECK(!sampler.contains(Vec2(3, 0)));
+    CHECK(sampler.contains(Vec2(-3, 0)));
+    for (int i : Range(100)) {
+      auto picked = sampler.getRandom(r, 10);
+      CHECK(picked.size() == 10);
+      CHECK(set<Vec2>(picked.begin(), picked.end()).size() == 10);
+      for (auto v : picked)
+        CHECK(sampler.contains(v));
+      CHECK(sampler.contains(*sampler.getRandom(r)));
+    }
+    CHECK(sampler.getRandom(r, 100).size() == 32);
+  }
+
+  void testMoveCache() {
+    resetMoveCacheStats();
+    MoveCache<int, int> cache("test");
+    int numComputed = 0;
+    auto compute = [&] { return ++numComputed; };
+    CHECK(cache.get(1, compute) == 1);
+    CHECK(cache.get(1, compute) == 1);
+    CHECK(cache.get(2, compute) == 2);
+    cache.clear();
+    CHECK(cache.get(2, compute) == 3);
+    CHECK(getMoveCacheStats("test").hits == 1);
+    CHECK(getMoveCacheStats("test").misses == 3);
+  }
+
+  void testSlabAllocator() {
+    SlabAllocator allocator(sizeof(double), 4);
+    vector<void*> blocks;
+    for (int i : Range(10))
+      blocks.push_back(allocator.allocate(sizeof(double)));
+    CHECK(allocator.getNumAllocated() == 10);
+    CHECK(allocator.getNumSlabs() == 3);
+    for (int i : Range(4))
+      allocator.deallocate(blocks[i], sizeof(double));
+    CHECK(allocator.getNumSlabs() == 2);
+    auto reused = allocator.allocate(sizeof(double));
+    CHECK(allocator.getNumSlabs() == 2);
+    for (int i : Range(4, 10))
+      allocator.deallocate(blocks[i], sizeof(double));
+    allocator.deallocate(reused, sizeof(double));
+    CHECK(allocator.getNumAllocated() == 0);
+    CHECK(allocator.getNumSlabs() == 0);
+  }
+
+  void testRandomSwap() {
+    RandomGen r1, r2, reference;
+    r1.init(1);
+    r2.init(2);
+    reference.init(2);
+    int before = r1.get(1000000);
+    r1.swap(r2);
+    for (int i : Range(10))
+      CHECK(r1.get(1000000) == reference.get(1000000));
+    r1.swap(r2);
+    reference.init(1);
+    CHECK(reference.get(1000000) == before);
+    CHECK(r1.get(1000000) == reference.get(1000000));
+  }
+
+  void testMeleeBatch() {
+    CHECK(getMeleeDamage(0.3) == 0);
+    CHECK(fabs(getMeleeDamage(1) - 0.12) < 0.000001);
+    CHECK(getMeleeDamage(2.2) == 1);
+    RandomGen random;
+    random.init(1234);
+    for (int round : Range(100)) {
+      int numHits = random.get(1, 8);
+      vector<int> strength;
+      vector<int> defenseIndex;
+      for (int i : Range(numHits)) {
+        strength.push_back(random.get(1, 60));
+        defenseIndex.push_back(random.get(3));
+      }
+      vector<double> defense;
+      for (int i : Range(3))
+        defense.push_back(random.get(1, 40) * random.getDouble(0.5, 1.5));
+      vector<double> damage(numHits);
+      MeleeBatch::resolve(strength, defenseIndex, defense, damage, 0);
+      // The victim's defense changes in the middle of the batch and the remaining hits are resolved again.
+      int changed = random.get(numHits);
+      auto newDefense = defense;
+      newDefense[defenseIndex[changed]] *= 1.3;
+      MeleeBatch::resolve(strength, defenseIndex, newDefense, damage, changed);
+      for (int i : Range(numHits))
+        CHECK(damage[i] == getMeleeDamage((double) strength[i] /
+            (i < changed ? defense : newDefense)[defenseIndex[i]]));
+    }
+  }
 };
 
 void testAll() {
@@ -1373,6 +1563,13 @@ void testAll() {
   Test().testVectorConcat4();
   Test().testVectorConcat5();
   Test().testVectorConcat6();
+  Test().testNoiseMap();
+  Test().testSortedValues();
+  Test().testTileSampler();
+  Test().testMoveCache();
+  Test().testSlabAllocator();
+  Test().testRandomSwap();
+  Test().testMeleeBatch();
   LastingEffects::runTests();
   INFO << "-----===== OK =====-----";
 }
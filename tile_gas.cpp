@@ -21,71 +21,162 @@
 #include "content_factory.h"
 #include "tile_gas_info.h"
 
-SERIALIZE_DEF(TileGas, amount)
+SERIALIZE_DEF(TileGas, bounds, fields)
+
+SERIALIZATION_CONSTRUCTOR_IMPL(TileGas)
+
+TileGas::TileGas(Rectangle b) : bounds(b) {
+}
 
 double TileGas::getFogVisionCutoff() {
   return 0.2;
 }
 
+int TileGas::getIndex(Vec2 pos) const {
+  CHECK(pos.inRectangle(bounds)) << pos << " " << bounds;
+  return (pos.x - bounds.left()) * bounds.height() + pos.y - bounds.top();
+}
+
+TileGas::Field& TileGas::getField(TileGasType type) {
+  if (auto res = getReferenceMaybe(fields, type))
+    return *res;
+  auto& ret = fields[type];
+  ret.total.resize(bounds.area());
+  ret.permanent.resize(bounds.area());
+  return ret;
+}
+
+static Rectangle extend(Rectangle r, Vec2 pos) {
+  if (r.empty())
+    return Rectangle(pos, pos + Vec2(1, 1));
+  return Rectangle(min(r.left(), pos.x), min(r.top(), pos.y), max(r.right(), pos.x + 1), max(r.bottom(), pos.y + 1));
+}
+
 void TileGas::addAmount(Position pos, TileGasType t, double a) {
   CHECK(a > 0);
-  auto prevValue = amount[t].total;
-  amount[t].total = min(1., a + amount[t].total);
-  if (prevValue < getFogVisionCutoff() && amount[t].total >= getFogVisionCutoff()) {
+  auto& field = getField(t);
+  auto& value = field.total[getIndex(pos.getCoord())];
+  auto prevValue = value;
+  value = min(1.0f, float(a) + value);
+  field.active = extend(field.active, pos.getCoord());
+  if (prevValue < getFogVisionCutoff() && value >= getFogVisionCutoff()) {
     if (pos.getGame()->getContentFactory()->tileGasTypes.at(t).blocksVision)
       pos.updateVisibility();
     pos.updateConnectivity();
   }
 }
 
-void TileGas::addPermanentAmount(TileGasType t, double a) {
-  auto& values = amount[t];
-  values.total = min(1.0, values.total + a);
-  values.permanent = min(1.0, values.permanent + a);
+void TileGas::addPermanentAmount(Vec2 pos, TileGasType t, double a) {
+  auto& field = getField(t);
+  auto index = getIndex(pos);
+  field.total[index] = min(1.0f, field.total[index] + float(a));
+  field.permanent[index] = min(1.0f, field.permanent[index] + float(a));
 }
 
-bool TileGas::hasSunlightBlockingAmount() const {
-  for (auto& elem : amount)
-    if (elem.second.total > getFogVisionCutoff())
+bool TileGas::hasSunlightBlockingAmount(Vec2 pos) const {
+  auto index = getIndex(pos);
+  for (auto& elem : fields)
+    if (elem.second.total[index] > getFogVisionCutoff())
       return true;
   return false;
 }
 
-void TileGas::tick(Position pos) {
+void TileGas::tick(Level* level) {
   PROFILE;
-  for (auto& elem : amount) {
-    auto& value = elem.second;
-    auto prevValue = value.total;
-    auto& info = pos.getGame()->getContentFactory()->tileGasTypes.at(elem.first);
-    if (info.effect && value.total > 0.01 && Random.chance(value.total))
-      info.effect->apply(pos);
-    if (value.total - value.permanent < 0.1)
-      value.total = value.permanent;
-    else {
-      if (info.spread > 0)
-        for (Position v : pos.neighbors8(Random)) {
-          if (v.canSeeThruIgnoringGas(VisionId::NORMAL) && value.total - value.permanent > 0 &&
-              v.getGasAmount(elem.first) < value.total) {
-            double transfer = pos.getDir(v).isCardinal4() ? info.spread : info.spread / 2;
-            transfer = min(value.total - value.permanent, transfer);
-            transfer = min((value.total - v.getGasAmount(elem.first)) / 2, transfer);
-            value.total -= transfer;
-            CHECK(value.total >= value.permanent);
-            v.addGas(elem.first, transfer);
-          }
-        }
-      value.total = max(value.permanent, value.permanent + (value.total - value.permanent) * info.decrease);
-    }
-    if (prevValue >= getFogVisionCutoff() && value.total < getFogVisionCutoff()) {
-      if (info.blocksVision)
-        pos.updateVisibility();
-      pos.updateConnectivity();
+  // Gas effects may release new gas types, so don't iterate the map directly.
+  for (auto type : getKeys(fields)) {
+    auto& field = fields.at(type);
+    if (!field.active.empty())
+      tickField(level, type, field);
+  }
+}
+
+void TileGas::tickField(Level* level, TileGasType type, Field& field) {
+  PROFILE;
+  auto& info = level->getGame()->getContentFactory()->tileGasTypes.at(type);
+  // Gas spreads by at most one tile per tick.
+  const auto area = field.active.minusMargin(-1).intersection(bounds);
+  // The local grid has a border of closed, empty cells so that the stencil loops below need no bounds checks.
+  const int height = area.height() + 2;
+  const int size = (area.width() + 2) * height;
+  for (auto elem : {&scratch.total, &scratch.permanent, &scratch.open, &scratch.source, &scratch.outflow,
+      &scratch.scale, &scratch.next}) {
+    elem->clear();
+    elem->resize(size);
+  }
+  auto getLocalIndex = [&](Vec2 v) { return (v.x - area.left() + 1) * height + v.y - area.top() + 1; };
+  for (Vec2 v : area) {
+    auto local = getLocalIndex(v);
+    auto index = getIndex(v);
+    scratch.total[local] = field.total[index];
+    scratch.permanent[local] = field.permanent[index];
+    scratch.open[local] = Position(v, level).canSeeThruIgnoringGas(VisionId::NORMAL) ? 1 : 0;
+    scratch.source[local] = field.total[index] - field.permanent[index] >= 0.1f ? 1 : 0;
+  }
+  const float* total = scratch.total.data();
+  const float* permanent = scratch.permanent.data();
+  const float* open = scratch.open.data();
+  const float* source = scratch.source.data();
+  float* outflow = scratch.outflow.data();
+  float* scale = scratch.scale.data();
+  float* next = scratch.next.data();
+  const float cardinal = info.spread;
+  const float diagonal = info.spread / 2;
+  const float decrease = info.decrease;
+  const int offsets[8] = {-1, 1, -height, height, -height - 1, -height + 1, height - 1, height + 1};
+  const float limits[8] = {cardinal, cardinal, cardinal, cardinal, diagonal, diagonal, diagonal, diagonal};
+  const int begin = height + 1;
+  const int end = size - height - 1;
+  // Each source tile offers half of the difference to every lower neighbor, limited by the spread rate.
+  for (int i = begin; i < end; ++i) {
+    float out = 0;
+    for (int j = 0; j < 8; ++j)
+      out += min(max(total[i] - total[i + offsets[j]], 0.0f) * 0.5f, limits[j]) * open[i + offsets[j]];
+    outflow[i] = out * source[i];
+  }
+  // A tile can't give away more than it has above its permanent amount.
+  for (int i = begin; i < end; ++i)
+    scale[i] = outflow[i] > 0 ? min(1.0f, (total[i] - permanent[i]) / outflow[i]) : 0.0f;
+  for (int i = begin; i < end; ++i) {
+    float in = 0;
+    for (int j = 0; j < 8; ++j)
+      in += min(max(total[i + offsets[j]] - total[i], 0.0f) * 0.5f, limits[j]) * scale[i + offsets[j]];
+    float kept = (total[i] - permanent[i] - outflow[i] * scale[i]) * decrease * source[i];
+    next[i] = min(1.0f, permanent[i] + kept + in * open[i]);
+  }
+  const float cutoff = getFogVisionCutoff();
+  vector<Position> crossedCutoff;
+  Rectangle active;
+  for (Vec2 v : area) {
+    auto index = getIndex(v);
+    auto prevValue = field.total[index];
+    auto value = next[getLocalIndex(v)];
+    field.total[index] = value;
+    if (value > field.permanent[index])
+      active = extend(active, v);
+    if (value != prevValue) {
+      Position pos(v, level);
+      pos.setNeedsRenderAndMemoryUpdate(true);
+      if ((prevValue >= cutoff) != (value >= cutoff))
+        crossedCutoff.push_back(pos);
     }
   }
+  field.active = active;
+  for (auto& pos : crossedCutoff) {
+    if (info.blocksVision)
+      pos.updateVisibility();
+    pos.updateConnectivity();
+  }
+  if (info.effect)
+    for (Vec2 v : area) {
+      auto value = field.total[getIndex(v)];
+      if (value > 0.01 && Random.chance(value))
+        info.effect->apply(Position(v, level));
+    }
 }
 
-double TileGas::getAmount(TileGasType type) const {
-  if (auto res = getReferenceMaybe(amount, type))
-    return res->total;
+double TileGas::getAmount(Vec2 pos, TileGasType type) const {
+  if (auto res = getReferenceMaybe(fields, type))
+    return res->total[getIndex(pos)];
   return 0;
 }
@@ -21,23 +21,40 @@
 
 class Level;
 
+/** Level-wide gas fields. Every gas type present on the level keeps a dense float grid and the bounding box
+    of cells holding more than their permanent amount, so that diffusion only touches the active area.*/
 class TileGas {
   public:
+  TileGas(Rectangle bounds);
   void addAmount(Position, TileGasType, double amount);
-  void addPermanentAmount(TileGasType, double amount);
-  void tick(Position);
-  double getAmount(TileGasType) const;
+  void addPermanentAmount(Vec2, TileGasType, double amount);
+  void tick(Level*);
+  double getAmount(Vec2, TileGasType) const;
   static double getFogVisionCutoff();
-  bool hasSunlightBlockingAmount() const;
+  bool hasSunlightBlockingAmount(Vec2) const;
 
-  template <class Archive>
-  void serialize(Archive& ar, const unsigned int version);
+  SERIALIZATION_DECL(TileGas)
 
   private:
-  struct AmountInfo {
-    double SERIAL(total);
-    double SERIAL(permanent);
-    SERIALIZE_ALL(total, permanent)
+  struct Field {
+    vector<float> SERIAL(total);
+    vector<float> SERIAL(permanent);
+    Rectangle SERIAL(active);
+    SERIALIZE_ALL(total, permanent, active)
   };
-  HashMap<TileGasType, AmountInfo> SERIAL(amount);
+  Field& getField(TileGasType);
+  int getIndex(Vec2) const;
+  void tickField(Level*, TileGasType, Field&);
+  Rectangle SERIAL(bounds);
+  HashMap<TileGasType, Field> SERIAL(fields);
+  struct Scratch {
+    vector<float> total;
+    vector<float> permanent;
+    vector<float> open;
+    vector<float> source;
+    vector<float> outflow;
+    vector<float> scale;
+    vector<float> next;
+  };
+  Scratch scratch;
 };
@@ -0,0 +1,52 @@
+#include "stdafx.h"
+#include "tile_sampler.h"
+
+TileSampler::TileSampler(Rectangle bounds) : indexes(bounds, -1) {
+}
+
+void TileSampler::insert(Vec2 v) {
+  if (indexes[v] == -1) {
+    indexes[v] = tiles.size();
+    tiles.push_back(v);
+  }
+}
+
+void TileSampler::erase(Vec2 v) {
+  int index = indexes[v];
+  if (index > -1) {
+    indexes[tiles.back()] = index;
+    tiles[index] = tiles.back();
+    tiles.pop_back();
+    indexes[v] = -1;
+  }
+}
+
+bool TileSampler::contains(Vec2 v) const {
+  return indexes[v] > -1;
+}
+
+int TileSampler::getSize() const {
+  return tiles.size();
+}
+
+optional<Vec2> TileSampler::getRandom(RandomGen& random) const {
+  if (tiles.empty())
+    return none;
+  return tiles[random.get(tiles.size())];
+}
+
+vector<Vec2> TileSampler::getRandom(RandomGen& random, int count) const {
+  if (count >= tiles.size())
+    return random.permutation(tiles);
+  // Floyd's algorithm picks a uniform subset of indices in count steps.
+  unordered_set<int> chosen;
+  vector<Vec2> ret;
+  for (int i : Range(tiles.size() - count, tiles.size())) {
+    int index = random.get(i + 1);
+    if (chosen.count(index))
+      index = i;
+    chosen.insert(index);
+    ret.push_back(tiles[index]);
+  }
+  return random.permutation(ret);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "util.h"
+
+class RandomGen;
+
+// Set of tiles within fixed bounds with constant time updates and uniform random picks.
+class TileSampler {
+  public:
+  TileSampler(Rectangle bounds);
+
+  void insert(Vec2);
+  void erase(Vec2);
+  bool contains(Vec2) const;
+  int getSize() const;
+  optional<Vec2> getRandom(RandomGen&) const;
+  // Returns min(count, getSize()) distinct tiles in random order.
+  vector<Vec2> getRandom(RandomGen&, int count) const;
+
+  private:
+  vector<Vec2> tiles;
+  Table<int> indexes;
+};
@@ -6,17 +6,31 @@
 #include "game_config.h"
 #include "tile_info.h"
 #include "scripted_ui.h"
+#include "sprite_atlas.h"
+
+static void addIfMissing(vector<optional<Tile>>& tiles, ViewId::InternalId id, Tile tile) {
+  if (id >= tiles.size())
+    tiles.resize(id + 1);
+  if (!tiles[id])
+    tiles[id] = std::move(tile);
+}
+
+static const Tile* getTileMaybe(const vector<optional<Tile>>& tiles, ViewId::InternalId id) {
+  if (id < tiles.size() && tiles[id])
+    return &*tiles[id];
+  return nullptr;
+}
 
 void TileSet::addTile(string id, Tile tile) {
-  tiles.insert(make_pair(ViewId(id.data()).getInternalId(), std::move(tile)));
+  addIfMissing(tiles, ViewId(id.data()).getInternalId(), std::move(tile));
 }
 
 void TileSet::addSymbol(string id, Tile tile) {
-  symbols.insert(make_pair(ViewId(id.data()).getInternalId(), std::move(tile)));
+  addIfMissing(symbols, ViewId(id.data()).getInternalId(), std::move(tile));
 }
 
 Color TileSet::getColor(ViewId id) const {
-  auto symbol = getReferenceMaybe(symbols, id.getInternalId());
+  auto symbol = getTileMaybe(symbols, id.getInternalId());
   CHECK(!!symbol) << "No symbol found for : " << id.data();
   return symbol->color;
 }
@@ -225,8 +239,10 @@ Tile TileSet::symbol(const string& s, Color id, bool symbol) {
   return Tile::fromString(s, id, symbol);
 }
 
-TileSet::TileSet(const DirectoryPath& defaultDir, const DirectoryPath& modsDir, const DirectoryPath& scriptedHelpDir)
-    : defaultDir(defaultDir), modsDir(modsDir), scriptedHelpDir(scriptedHelpDir) {
+TileSet::TileSet(const DirectoryPath& defaultDir, const DirectoryPath& modsDir, const DirectoryPath& scriptedHelpDir,
+    const DirectoryPath& cacheDir)
+    : defaultDir(defaultDir), modsDir(modsDir), scriptedHelpDir(scriptedHelpDir), cacheDir(cacheDir) {
+  cacheDir.createIfDoesntExist();
 }
 
 void TileSet::clear() {
@@ -294,9 +310,10 @@ void TileSet::reload() {
 
 const Tile& TileSet::getTile(ViewId viewId, bool sprite) const {
   auto id = viewId.getInternalId();
-  if (sprite && tiles.count(id))
-    return tiles.at(id);
-  else if (auto symbol = getReferenceMaybe(symbols, id))
+  auto tile = sprite ? getTileMaybe(tiles, id) : nullptr;
+  if (tile)
+    return *tile;
+  else if (auto symbol = getTileMaybe(symbols, id))
     return *symbol;
   else {
     static Tile unknown = Tile::fromString("?", Color::GREEN);
@@ -306,21 +323,6 @@ const Tile& TileSet::getTile(ViewId viewId, bool sprite) const {
 
 constexpr int textureWidth = 720;
 
-static int getNumFrames(const vector<FilePath>& files, int tileWidth) {
-  int ret = 0;
-  bool firstError = true;
-  for (int i : All(files))
-    if (SDL::SDL_Surface* im = SDL::IMG_Load(files[i].getPath())) {
-      auto dest = OnExit([&] { SDL::SDL_FreeSurface(im); });
-      ret += im->w / tileWidth;
-    } else
-    if (firstError) {
-      USER_INFO << "Error loading image " << files[i].getPath() << ": " << SDL::IMG_GetError();
-      firstError = true;
-    }
-  return ret;
-}
-
 bool TileSet::loadTilesFromDir(const DirectoryPath& path, Vec2 size, bool overwrite) {
   if (!path.exists())
     return false;
@@ -328,44 +330,28 @@ bool TileSet::loadTilesFromDir(const DirectoryPath& path, Vec2 size, bool overwr
   auto files = path.getFiles().filter([](const FilePath& f) { return f.hasSuffix(imageSuf);});
   if (files.empty())
     return false;
+  auto atlas = SpriteAtlas::loadOrBuild(files, size, textureWidth,
+      cacheDir.file("atlas" + toString(combineHash(string(path.getPath()))) + ".dat"));
   int rowLength = textureWidth / size.x;
-  const auto numFrames = getNumFrames(files, size.x);
-  SDL::SDL_Surface* image = Texture::createSurface(textureWidth, (numFrames / rowLength + 1) * size.y);
-  SDL::SDL_SetSurfaceBlendMode(image, SDL::SDL_BLENDMODE_NONE);
+  auto atlasSize = atlas.getSize();
+  SDL::SDL_Surface* image = Texture::createSurface(atlasSize.x, atlasSize.y);
   CHECK(image) << SDL::SDL_GetError();
+  for (int y : Range(atlasSize.y))
+    memcpy((unsigned char*)image->pixels + y * image->pitch, atlas.getPixels() + y * atlasSize.x * 4, atlasSize.x * 4);
   int frameCount = 0;
   vector<pair<string, Vec2>> addedPositions;
-  for (int i : All(files))
-    if (SDL::SDL_Surface* im = SDL::IMG_Load(files[i].getPath())) {
-      auto dest = OnExit([&] { SDL::SDL_FreeSurface(im); });
-      SDL::SDL_SetSurfaceBlendMode(im, SDL::SDL_BLENDMODE_NONE);
-      USER_CHECK(im) << files[i] << ": "<< SDL::IMG_GetError();
-      USER_CHECK((im->w % size.x == 0) && im->h == size.y) << files[i] << " has wrong size " << im->w << " " << im->h;
-      string fileName = files[i].getFileName();
-      string spriteName = fileName.substr(0, fileName.size() - imageSuf.size());
-      if (tileCoords.count(spriteName)) {
-        if (overwrite)
-          tileCoords.erase(spriteName);
-        else
-          continue;
-      }
-      for (int frame : Range(im->w / size.x)) {
-        SDL::SDL_Rect dest;
-        int posX = frameCount % rowLength;
-        int posY = frameCount / rowLength;
-        dest.x = size.x * posX;
-        dest.y = size.y * posY;
-        SDL::SDL_Rect src;
-        src.x = frame * size.x;
-        src.y = 0;
-        src.w = size.x;
-        src.h = size.y;
-        SDL_BlitSurface(im, &src, image, &dest);
-        addedPositions.emplace_back(spriteName, Vec2(posX, posY));
-        INFO << "Loading tile sprite " << fileName << " at " << posX << "," << posY;
-        ++frameCount;
-      }
+  for (auto& sprite : atlas.getSprites()) {
+    int firstFrame = frameCount;
+    frameCount += sprite.numFrames;
+    if (tileCoords.count(sprite.name)) {
+      if (overwrite)
+        tileCoords.erase(sprite.name);
+      else
+        continue;
     }
+    for (int frame : Range(firstFrame, frameCount))
+      addedPositions.emplace_back(sprite.name, Vec2(frame % rowLength, frame / rowLength));
+  }
   texturesTmp.push_back({image, addedPositions});
   for (auto& pos : addedPositions)
     tileCoords[pos.first].push_back({size, pos.second, nullptr});
@@ -20,7 +20,8 @@ struct TileCoord {
 
 class TileSet {
   public:
-  TileSet(const DirectoryPath& defaultDir, const DirectoryPath& modsDir, const DirectoryPath& scriptedHelpDir);
+  TileSet(const DirectoryPath& defaultDir, const DirectoryPath& modsDir, const DirectoryPath& scriptedHelpDir,
+      const DirectoryPath& cacheDir);
   void setTilePaths(const TilePaths&);
   void setTilePathsAndReload(const TilePaths&);
   const TilePaths& getTilePaths() const;
@@ -41,11 +42,13 @@ class TileSet {
   DirectoryPath defaultDir;
   DirectoryPath modsDir;
   DirectoryPath scriptedHelpDir;
+  DirectoryPath cacheDir;
   friend class TileCoordLookup;
   void addTile(string, Tile);
   void addSymbol(string, Tile);
-  unordered_map<ViewId::InternalId, Tile> tiles;
-  unordered_map<ViewId::InternalId, Tile> symbols;
+  // Indexed by ViewId::InternalId, since getTile is called for every drawn object.
+  vector<optional<Tile>> tiles;
+  vector<optional<Tile>> symbols;
   vector<unique_ptr<Texture>> textures;
   struct TmpInfo {
     SDL::SDL_Surface* image;
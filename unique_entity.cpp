@@ -38,7 +38,7 @@ long long UniqueEntity<T>::offset = 0;
 
 template<typename T>
 UniqueEntity<T>::Id::Id() {
-  key = Random.getLL();
+  key = IdRandom.getLL();
   hash = int(key);
 }
 
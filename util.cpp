@@ -88,6 +88,11 @@ bool RandomGen::chance(float v) {
   return getFloat(0, 1) <= v;
 }
 
+void RandomGen::swap(RandomGen& o) {
+  std::swap(generator, o.generator);
+  std::swap(defaultDist, o.defaultDist);
+}
+
 double RandomGen::getDouble() {
   return defaultDist(generator);
 }
@@ -114,6 +119,7 @@ float RandomGen::getFloatFast(float a, float b) {
 }
 
 RandomGen Random;
+RandomGen IdRandom;
 
 template string toString<int>(const int&);
 template string toString<unsigned int>(const unsigned int&);
@@ -720,6 +720,8 @@ class RandomGen {
   bool roll(int chance);
   bool chance(double chance);
   bool chance(float chance);
+  // Exchanges the state of the two generators.
+  void swap(RandomGen&);
   template <typename T>
   const T& choose(const vector<T>& v, const vector<double>& p) {
     CHECK(v.size() == p.size());
@@ -889,6 +891,8 @@ class RandomGen {
 };
 
 extern RandomGen Random;
+// Mints unique entity, level and stair ids. Kept apart from Random, which is reseeded for every model generation attempt.
+extern RandomGen IdRandom;
 
 inline std::ostream& operator <<(std::ostream& d, Rectangle rect) {
   return d << "(" << rect.left() << "," << rect.top() << ") (" << rect.right() << "," << rect.bottom() << ")";
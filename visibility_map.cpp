@@ -2,46 +2,72 @@
 #include "visibility_map.h"
 #include "creature.h"
 #include "vision.h"
+#include "level.h"
 
 SERIALIZE_DEF(VisibilityMap, lastUpdates, visibilityCount, eyeballs)
 
-void VisibilityMap::addPositions(const vector<Position>& positions) {
-  for (Position v : positions)
-    if (++visibilityCount.getOrInit(v) == 1)
-      v.setNeedsRenderUpdate(true);
+const VisibilityMap::LevelCount* VisibilityMap::getLevelCount(Position pos) const {
+  auto levelId = pos.getLevel()->getUniqueId();
+  if (lastLevel < visibilityCount.size() && visibilityCount[lastLevel].levelId == levelId)
+    return &visibilityCount[lastLevel];
+  for (int i : All(visibilityCount))
+    if (visibilityCount[i].levelId == levelId) {
+      lastLevel = i;
+      return &visibilityCount[i];
+    }
+  return nullptr;
 }
 
-void VisibilityMap::removePositions(const vector<Position>& positions) {
-  for (Position v : positions)
-    if (--visibilityCount.getOrFail(v) == 0)
-      v.setNeedsRenderUpdate(true);
+int& VisibilityMap::getCount(Position pos) {
+  auto level = const_cast<LevelCount*>(getLevelCount(pos));
+  if (!level) {
+    lastLevel = visibilityCount.size();
+    visibilityCount.push_back(LevelCount{pos.getLevel()->getUniqueId(), Table<int>(pos.getLevel()->getBounds(), 0)});
+    level = &visibilityCount.back();
+  }
+  return level->count[pos.getCoord()];
+}
+
+void VisibilityMap::updatePositions(const PositionSet& from, const PositionSet& to) {
+  PositionSet::getDifference(from, to,
+      [&](Position v) {
+        if (v.isValid() && ++getCount(v) == 1)
+          v.setNeedsRenderUpdate(true);
+      },
+      [&](Position v) {
+        if (v.isValid() && --getCount(v) == 0)
+          v.setNeedsRenderUpdate(true);
+      });
 }
 
 void VisibilityMap::update(const Creature* c, const vector<Position>& visibleTiles) {
   PROFILE;
-  remove(c);
-  lastUpdates.set(c, visibleTiles);
-  addPositions(visibleTiles);
+  PositionSet tiles(visibleTiles.begin(), visibleTiles.end());
+  auto& last = lastUpdates.getOrInit(c);
+  updatePositions(last, tiles);
+  last = std::move(tiles);
 }
 
 void VisibilityMap::remove(const Creature* c) {
-  if (auto positions = lastUpdates.getMaybe(c))
-    removePositions(*positions);
-  lastUpdates.erase(c);
+  if (lastUpdates.hasKey(c)) {
+    updatePositions(lastUpdates.getOrFail(c), PositionSet());
+    lastUpdates.erase(c);
+  }
 }
 
 const static Vision eyeballVision;
 
 void VisibilityMap::updateEyeball(Position pos) {
-  removeEyeball(pos);
   auto visibleTiles = pos.getVisibleTiles(eyeballVision);
-  eyeballs.set(pos, visibleTiles);
-  addPositions(visibleTiles);
+  PositionSet tiles(visibleTiles.begin(), visibleTiles.end());
+  auto& last = eyeballs.getOrInit(pos);
+  updatePositions(last, tiles);
+  last = std::move(tiles);
 }
 
 void VisibilityMap::removeEyeball(Position pos) {
   if (auto positions = eyeballs.getReferenceMaybe(pos))
-    removePositions(*positions);
+    updatePositions(*positions, PositionSet());
   eyeballs.erase(pos);
 }
 
@@ -54,6 +80,9 @@ void VisibilityMap::onVisibilityChanged(Position pos) {
 }
 
 bool VisibilityMap::isVisible(Position pos) const {
-  return visibilityCount.getValueMaybe(pos).value_or(0) > 0;
+  if (!pos.isValid())
+    return false;
+  if (auto level = getLevelCount(pos))
+    return level->count[pos.getCoord()] > 0;
+  return false;
 }
-
@@ -21,11 +21,17 @@ class VisibilityMap {
   void serialize(Archive& ar, const unsigned int version);
 
   private:
-  EntityMap<Creature, vector<Position>> SERIAL(lastUpdates);
-  PositionMap<vector<Position>> SERIAL(eyeballs);
-  PositionMap<int> SERIAL(visibilityCount);
-  void addPositions(const vector<Position>&);
-  void removePositions(const vector<Position>&);
+  struct LevelCount {
+    LevelId SERIAL(levelId);
+    Table<int> SERIAL(count);
+    SERIALIZE_ALL(levelId, count)
+  };
+  EntityMap<Creature, PositionSet> SERIAL(lastUpdates);
+  PositionMap<PositionSet> SERIAL(eyeballs);
+  vector<LevelCount> SERIAL(visibilityCount);
+  mutable int lastLevel = 0;
+  const LevelCount* getLevelCount(Position) const;
+  int& getCount(Position);
+  void updatePositions(const PositionSet& from, const PositionSet& to);
 };
 
-
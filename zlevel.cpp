@@ -16,8 +16,8 @@ int getZLevelCombatExp(int depth) {
   return abs(depth) * 3 / 2;
 }
 
-static EnemyInfo getEnemy(EnemyId id, ContentFactory* contentFactory) {
-  auto enemy = EnemyFactory(Random, contentFactory->getCreatures().getNameGenerator(), contentFactory->enemies,
+static EnemyInfo getEnemy(RandomGen& random, EnemyId id, ContentFactory* contentFactory) {
+  auto enemy = EnemyFactory(random, contentFactory->getCreatures().getNameGenerator(), contentFactory->enemies,
       contentFactory->buildingInfo, {}).get(id);
   enemy.settlement.collective = new CollectiveBuilder(enemy.config, enemy.settlement.tribe);
   return enemy;
@@ -31,24 +31,24 @@ static double modifyAggression(double value, EnemyAggressionLevel aggressionLeve
   }
 }
 
-static LevelMakerResult getLevelMaker(const ZLevelType& levelInfo, ResourceCounts resources, TribeId tribe,
+static LevelMakerResult getLevelMaker(RandomGen& random, const ZLevelType& levelInfo, ResourceCounts resources, TribeId tribe,
     ContentFactory* contentFactory, Vec2 size, EnemyAggressionLevel aggressionLevel, int difficulty) {
   return levelInfo.visit(
       [&](const WaterZLevel& level) {
         return LevelMakerResult{
-            LevelMaker::getWaterZLevel(Random, level.waterType, size.x, level.creatures),
+            LevelMaker::getWaterZLevel(random, level.waterType, size.x, level.creatures),
             vector<EnemyInfo>()
         };
       },
       [&](const EnemyZLevel& level) {
-        auto enemy = getEnemy(level.enemy, contentFactory);
+        auto enemy = getEnemy(random, level.enemy, contentFactory);
         CHECK(level.attackChance < 0.0001 || !!enemy.behaviour)
             << "Z-level enemy " << level.enemy.data() << " has positive attack chance, but no attack behaviour defined";
-        if (Random.chance(modifyAggression(level.attackChance, aggressionLevel))) {
+        if (random.chance(modifyAggression(level.attackChance, aggressionLevel))) {
           enemy.behaviour->triggers.push_back(Immediate{});
         }
         return LevelMakerResult{
-            LevelMaker::settlementLevel(*contentFactory, Random, enemy.settlement, size,
+            LevelMaker::settlementLevel(*contentFactory, random, enemy.settlement, size,
                 resources, tribe, level.mountainType, difficulty),
             vector<EnemyInfo>{std::move(enemy)}
         };
@@ -57,16 +57,16 @@ static LevelMakerResult getLevelMaker(const ZLevelType& levelInfo, ResourceCount
         optional<SettlementInfo> settlement;
         vector<EnemyInfo> enemy;
         if (level.enemy) {
-          enemy.push_back(getEnemy(*level.enemy, contentFactory));
+          enemy.push_back(getEnemy(random, *level.enemy, contentFactory));
           settlement = enemy[0].settlement;
           CHECK(level.attackChance < 0.0001 || !!enemy[0].behaviour)
               << "Z-level enemy " << level.enemy->data() << " has positive attack chance, but no attack behaviour defined";
-          if (Random.chance(modifyAggression(level.attackChance, aggressionLevel))) {
+          if (random.chance(modifyAggression(level.attackChance, aggressionLevel))) {
             enemy[0].behaviour->triggers.push_back(Immediate{});
           }
         }
         return LevelMakerResult{
-            LevelMaker::getFullZLevel(Random, settlement, resources, size.x, tribe, *contentFactory, difficulty),
+            LevelMaker::getFullZLevel(random, settlement, resources, size.x, tribe, *contentFactory, difficulty),
             std::move(enemy)
         };
       });
@@ -79,7 +79,7 @@ LevelMakerResult getLevelMaker(RandomGen& random, ContentFactory* contentFactory
     levels.append(contentFactory->zLevels.at(group));
   auto zLevel = *chooseZLevel(random, levels, depth);
   auto res = *chooseResourceCounts(random, contentFactory->resources, depth);
-  return getLevelMaker(zLevel, res, tribe, contentFactory, size, aggressionLevel, getZLevelCombatExp(depth));
+  return getLevelMaker(random, zLevel, res, tribe, contentFactory, size, aggressionLevel, getZLevelCombatExp(depth));
 }
 
 
@@ -90,13 +90,13 @@ LevelMakerResult getUpLevel(RandomGen& random, ContentFactory* contentFactory,
   if (withEnemy)
     for (auto& enemyInfo : biomeInfo.mountainEnemies)
       if (enemyInfo.first.contains(depth) && random.chance(enemyInfo.second.probability))
-        for (int it : Range(Random.get(enemyInfo.second.count))) {
-          enemies.push_back(getEnemy(enemyInfo.second.id, contentFactory));
+        for (int it : Range(random.get(enemyInfo.second.count))) {
+          enemies.push_back(getEnemy(random, enemyInfo.second.id, contentFactory));
           enemies.back().settlement.collective = new CollectiveBuilder(enemies.back().config,
               enemies.back().settlement.tribe);
         }
   auto res = chooseResourceCounts(random, contentFactory->resources, -depth);
-  auto maker = LevelMaker::upLevel(pos, biomeInfo, enemies.transform([](auto e) {return e.settlement; }), res);
+  auto maker = LevelMaker::upLevel(random, pos, biomeInfo, enemies.transform([](auto e) {return e.settlement; }), res);
   auto size = pos.getModel()->getGroundLevel()->getBounds().getSize();
   return LevelMakerResult { std::move(maker), std::move(enemies)};
 }